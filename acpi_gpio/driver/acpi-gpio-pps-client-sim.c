@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * acpi-gpio-pps-client-sim - instantiates the gpio pps client on a gpio-sim chip
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#include <linux/gpio/driver.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/platform_device.h>
+#include <linux/property.h>
+#include <linux/slab.h>
+
+#define DRIVER_NAME	"acpi_gpio_pps_client_sim"
+#define CLIENT_NAME	"acpi_gpio_pps_client"
+#define CHIP_LABEL	"gpio-sim.0-node0"
+#define LINES		8
+#define MAX_LINES	64
+
+static char *chip = CHIP_LABEL;
+module_param(chip, charp, 0444);
+MODULE_PARM_DESC(chip, "label of the gpio-sim chip to use (default: '" CHIP_LABEL "')");
+
+static unsigned int lines = LINES;
+module_param(lines, uint, 0444);
+MODULE_PARM_DESC(lines, "number of chip lines exposed as GPIO00.. (default: "
+		 __MODULE_STRING(LINES) " max " __MODULE_STRING(MAX_LINES) ")");
+
+static struct platform_device *client_pdev;
+
+static int acpi_gpio_pps_client_sim_match(struct gpio_chip *gc, void *data)
+{
+	return gc->label && !strcmp(gc->label, data);
+}
+
+static int __init acpi_gpio_pps_client_sim_init(void)
+{
+	struct platform_device_info pdevinfo = {
+		.name	= CLIENT_NAME,
+		.id	= PLATFORM_DEVID_AUTO,
+	};
+	const struct software_node *swnode;
+	struct software_node_ref_args *refs;
+	struct property_entry *props;
+	struct gpio_chip *gc;
+	char (*names)[16];
+	unsigned int i;
+	int err = 0;
+
+	if (!lines || lines > MAX_LINES)
+		return -EINVAL;
+
+	gc = gpiochip_find(chip, acpi_gpio_pps_client_sim_match);
+	if (!gc) {
+		pr_err("%s: gpio chip '%s' not found\n", DRIVER_NAME, chip);
+		return -ENODEV;
+	}
+
+	/* gpio-sim describes every bank by a software node, the client references its lines */
+	swnode = to_software_node(gc->fwnode);
+	if (!swnode) {
+		pr_err("%s: gpio chip '%s' has no software node\n", DRIVER_NAME, chip);
+		return -ENODEV;
+	}
+	if (lines > gc->ngpio)
+		lines = gc->ngpio;
+
+	refs = kcalloc(lines, sizeof(*refs), GFP_KERNEL);
+	props = kcalloc(lines + 1, sizeof(*props), GFP_KERNEL);
+	names = kcalloc(lines, sizeof(*names), GFP_KERNEL);
+	if (!refs || !props || !names) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < lines; ++i) {
+		snprintf(names[i], sizeof(names[i]), "GPIO%02u-gpios", i);
+		refs[i] = SOFTWARE_NODE_REFERENCE(swnode, i, 0);
+		props[i] = PROPERTY_ENTRY_REF_ARRAY_LEN(names[i], &refs[i], 1);
+	}
+
+	/* the properties get copied into the software node of the new device */
+	pdevinfo.properties = props;
+	client_pdev = platform_device_register_full(&pdevinfo);
+	if (IS_ERR(client_pdev)) {
+		err = PTR_ERR(client_pdev);
+		pr_err("%s: failed to register %s device (%d)\n", DRIVER_NAME, CLIENT_NAME, err);
+		goto out;
+	}
+
+	pr_info("%s: %s uses %u lines of '%s'\n", DRIVER_NAME, dev_name(&client_pdev->dev), lines,
+		chip);
+
+out:
+	kfree(names);
+	kfree(props);
+	kfree(refs);
+
+	return err;
+}
+module_init(acpi_gpio_pps_client_sim_init);
+
+static void __exit acpi_gpio_pps_client_sim_exit(void)
+{
+	platform_device_unregister(client_pdev);
+}
+module_exit(acpi_gpio_pps_client_sim_exit);
+
+MODULE_AUTHOR("Wilken Gottwalt");
+MODULE_DESCRIPTION("gpio pps client instance on gpio-sim lines");
+MODULE_LICENSE("GPL v2");
+MODULE_ALIAS("acpi-gpio-pps-client-sim");
@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * acpi-gpio-pps-client - trace events
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM acpi_gpio_pps_client
+
+#if !defined(_ACPI_GPIO_PPS_CLIENT_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _ACPI_GPIO_PPS_CLIENT_TRACE_H
+
+#include <linux/time64.h>
+#include <linux/tracepoint.h>
+
+/* one captured edge, the timestamp is the one handed to the PPS core (compensated) */
+TRACE_EVENT(acpi_gpio_pps_client_edge,
+
+	TP_PROTO(const char *client, int irq, const struct timespec64 *ts, bool assert,
+		 s64 compensation_ns),
+
+	TP_ARGS(client, irq, ts, assert, compensation_ns),
+
+	TP_STRUCT__entry(
+		__string(client, client)
+		__field(int, irq)
+		__field(s64, sec)
+		__field(long, nsec)
+		__field(bool, assert)
+		__field(s64, compensation_ns)
+	),
+
+	TP_fast_assign(
+		__assign_str(client, client);
+		__entry->irq = irq;
+		__entry->sec = ts->tv_sec;
+		__entry->nsec = ts->tv_nsec;
+		__entry->assert = assert;
+		__entry->compensation_ns = compensation_ns;
+	),
+
+	TP_printk("client=%s irq=%d edge=%s ts=%lld.%09ld compensation_ns=%lld",
+		  __get_str(client), __entry->irq, __entry->assert ? "assert" : "clear",
+		  __entry->sec, __entry->nsec, __entry->compensation_ns)
+);
+
+#endif /* _ACPI_GPIO_PPS_CLIENT_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE acpi-gpio-pps-client-trace
+#include <trace/define_trace.h>
@@ -5,47 +5,996 @@
  */
 
 #include <linux/acpi.h>
+#include <linux/completion.h>
+#include <linux/fs.h>
 #include <linux/gpio/consumer.h>
+#include <linux/hrtimer.h>
 #include <linux/interrupt.h>
 #include <linux/kernel.h>
+#include <linux/kref.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
 #include <linux/platform_device.h>
+#include <linux/poll.h>
 #include <linux/pps_kernel.h>
+#include <linux/property.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
+#include <asm/local64.h>
+#include "acpi-gpio-pps-client.h"
+
+#define CREATE_TRACE_POINTS
+#include "acpi-gpio-pps-client-trace.h"
 
 #define DRIVER_NAME	"acpi_gpio_pps_client"
-#define MAX_GPIOS	8
 #define GPIO_MASK	1
+#define EVENT_BUFFER	0
+#define MAX_EVENT_BUFFER	(1 << 20)
+#define READ_BATCH	16
+#define ECHO_WIDTH	100
+#define ECHO_HIST_SIZE	32
+#define SELFTEST_PERIOD	10
+#define CALIBRATE_PULSES	100
+#define COUNTER_MASK	0
+#define COUNTER_GATE	1000
+
+static unsigned long gpios_mask = GPIO_MASK;
+module_param(gpios_mask, ulong, 0444);
+MODULE_PARM_DESC(gpios_mask, "bitmask of discovered GPIOs to setup as PPS sources, in firmware "
+		 "order (default: " __MODULE_STRING(GPIO_MASK) ")");
+
+static bool all_gpios;
+module_param(all_gpios, bool, 0444);
+MODULE_PARM_DESC(all_gpios, "setup every discovered GPIO as PPS source, ignores gpios_mask "
+		 "(default: false)");
+
+static unsigned long counter_mask = COUNTER_MASK;
+module_param(counter_mask, ulong, 0444);
+MODULE_PARM_DESC(counter_mask, "bitmask of discovered GPIOs to setup as edge counters instead of "
+		 "PPS sources, in firmware order (default: " __MODULE_STRING(COUNTER_MASK) ")");
+
+static unsigned int counter_gate = COUNTER_GATE;
+module_param(counter_gate, uint, 0444);
+MODULE_PARM_DESC(counter_gate, "default gate time of the frequency measurement in milliseconds "
+		 "(default: " __MODULE_STRING(COUNTER_GATE) ")");
+
+static unsigned int event_buffer = EVENT_BUFFER;
+module_param(event_buffer, uint, 0444);
+MODULE_PARM_DESC(event_buffer, "number of buffered edge events per PPS source, 0 disables the "
+		 "event devices (default: " __MODULE_STRING(EVENT_BUFFER) " max "
+		 __MODULE_STRING(MAX_EVENT_BUFFER) ")");
+
+static char *echo_gpio = "";
+module_param(echo_gpio, charp, 0444);
+MODULE_PARM_DESC(echo_gpio, "GPIO pulsed on every assert event with PPS_ECHOASSERT enabled "
+		 "(default: none)");
 
-static const char *const gpio_names[MAX_GPIOS] = {
-	"GPIO00", "GPIO01", "GPIO02", "GPIO03", "GPIO4", "GPIO5", "GPIO06", "GPIO07",
+static unsigned int echo_width = ECHO_WIDTH;
+module_param(echo_width, uint, 0444);
+MODULE_PARM_DESC(echo_width, "echo pulse width in microseconds (default: "
+		 __MODULE_STRING(ECHO_WIDTH) ")");
+
+static char *echo_loopback = "";
+module_param(echo_loopback, charp, 0444);
+MODULE_PARM_DESC(echo_loopback, "PPS GPIO the echo output is wired back to, used for latency "
+		 "measurements, echo_calibrate selects another one at runtime (default: none)");
+
+struct acpi_gpio_pps_client_ring {
+	struct kref ref;
+	struct miscdevice misc;
+	wait_queue_head_t wait;
+	struct pps_client_ring_header *hdr;
+	struct pps_client_event *events;
+	unsigned long mem_size;
+	u64 head;
+	u32 mask;
+	bool dead;
+	char name[PPS_MAX_NAME_LEN];
+};
+#define to_ring(x) container_of(x, struct acpi_gpio_pps_client_ring, misc)
+
+struct acpi_gpio_pps_client_reader {
+	struct acpi_gpio_pps_client_ring *ring;
+	u64 pos;
 };
 
-static int gpios_mask = GPIO_MASK;
-module_param(gpios_mask, int, 0444);
-MODULE_PARM_DESC(gpios_mask, "bitmask of GPIOs to setup as PPS sources (default: "
-		 __MODULE_STRING(GPIO_MASK) " max 255)");
+struct acpi_gpio_pps_client_latency {
+	u64 count;
+	u64 sum;
+	u64 min;
+	u64 max;
+	u64 hist[ECHO_HIST_SIZE];
+};
 
 struct acpi_gpio_pps_client_device_data {
+	struct acpi_gpio_pps_client_data *priv;
+	const char *name;
 	struct gpio_desc *gpio;
 	struct pps_device *pps;
 	struct pps_source_info pps_info;
+	struct acpi_gpio_pps_client_ring *ring;
+	s64 latency_ns;
 	int irq;
+	bool cansleep;
+
+	/* counter mode, no PPS source and no per edge wakeups */
+	local64_t __percpu *counts;
+	u64 last_edge_ns;
+	struct delayed_work gate_work;
+	unsigned int gate_ms;
+	u64 gate_count;
+	u64 gate_ns;
+	u64 frequency_millihz;
+
+	struct device_attribute latency_attr;
+	struct device_attribute count_attr;
+	struct device_attribute frequency_attr;
+	struct device_attribute gate_attr;
+	struct device_attribute last_edge_attr;
+	struct attribute *attrs[5];
+	struct attribute_group attr_group;
 };
 
 struct acpi_gpio_pps_client_data {
 	struct device *dev;
-	struct acpi_gpio_pps_client_device_data pps_client[MAX_GPIOS];
+	struct acpi_gpio_pps_client_device_data *pps_client;
 	int clients;
+	const char **gpio_names;
+	int gpios_count;
+
+	/* echo output and loopback latency measurement, only selftest pulses are measured */
+	struct gpio_desc *echo;
+	struct hrtimer echo_timer;
+	struct delayed_work selftest_work;
+	struct completion selftest_done;
+	struct mutex selftest_lock;
+	atomic_t selftest_pulses;
+	atomic64_t echo_ref_ns;
+	struct acpi_gpio_pps_client_device_data *loopback;
+	struct acpi_gpio_pps_client_latency latency;
+	spinlock_t latency_lock;
+};
+
+/*----- event buffer -----*/
+
+/*
+ * Called from the IRQ handler only, so there is exactly one writer per ring. The writer never
+ * waits for readers, it simply overwrites the oldest slot. Readers detect that by the sequence
+ * number of the slot, which is cleared while the slot is rewritten.
+ */
+static void acpi_gpio_pps_client_ring_push(struct acpi_gpio_pps_client_ring *ring,
+					   const struct timespec64 *ts, u32 flags)
+{
+	struct pps_client_event *ev = &ring->events[ring->head & ring->mask];
+	u64 seq = ring->head + 1;
+
+	WRITE_ONCE(ev->sequence, 0);
+	smp_wmb();
+	ev->sec = ts->tv_sec;
+	ev->nsec = ts->tv_nsec;
+	ev->flags = flags;
+	smp_wmb();
+	WRITE_ONCE(ev->sequence, seq);
+
+	ring->head = seq;
+	smp_store_release(&ring->hdr->head, seq);
+
+	if (wq_has_sleeper(&ring->wait))
+		wake_up_interruptible(&ring->wait);
+}
+
+/* returns false if the slot got overwritten while it was copied */
+static bool acpi_gpio_pps_client_ring_copy(struct acpi_gpio_pps_client_ring *ring, u64 pos,
+					   struct pps_client_event *ev)
+{
+	const struct pps_client_event *slot = &ring->events[pos & ring->mask];
+	u64 seq;
+
+	seq = READ_ONCE(slot->sequence);
+	smp_rmb();
+	*ev = *slot;
+	smp_rmb();
+
+	return seq == pos + 1 && READ_ONCE(slot->sequence) == seq;
+}
+
+static void acpi_gpio_pps_client_ring_release(struct kref *ref)
+{
+	struct acpi_gpio_pps_client_ring *ring = container_of(ref, struct acpi_gpio_pps_client_ring,
+							       ref);
+
+	vfree(ring->hdr);
+	kfree(ring);
+}
+
+static int acpi_gpio_pps_client_ring_open(struct inode *inode, struct file *file)
+{
+	struct acpi_gpio_pps_client_ring *ring = to_ring(file->private_data);
+	struct acpi_gpio_pps_client_reader *reader;
+
+	reader = kzalloc(sizeof(*reader), GFP_KERNEL);
+	if (!reader)
+		return -ENOMEM;
+
+	kref_get(&ring->ref);
+	reader->ring = ring;
+	reader->pos = smp_load_acquire(&ring->hdr->head);
+	file->private_data = reader;
+
+	return stream_open(inode, file);
+}
+
+static int acpi_gpio_pps_client_ring_close(struct inode *inode, struct file *file)
+{
+	struct acpi_gpio_pps_client_reader *reader = file->private_data;
+
+	kref_put(&reader->ring->ref, acpi_gpio_pps_client_ring_release);
+	kfree(reader);
+
+	return 0;
+}
+
+static ssize_t acpi_gpio_pps_client_ring_read(struct file *file, char __user *buf, size_t count,
+					      loff_t *ppos)
+{
+	struct acpi_gpio_pps_client_reader *reader = file->private_data;
+	struct acpi_gpio_pps_client_ring *ring = reader->ring;
+	struct pps_client_event evs[READ_BATCH];
+	size_t wanted = count / sizeof(evs[0]);
+	size_t done = 0;
+	u64 head;
+	int err;
+
+	if (!wanted)
+		return -EINVAL;
+
+	head = smp_load_acquire(&ring->hdr->head);
+	while (head == reader->pos) {
+		if (READ_ONCE(ring->dead))
+			return 0;
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		err = wait_event_interruptible(ring->wait,
+					       smp_load_acquire(&ring->hdr->head) != reader->pos ||
+					       READ_ONCE(ring->dead));
+		if (err)
+			return err;
+
+		head = smp_load_acquire(&ring->hdr->head);
+	}
+
+	while (done < wanted && reader->pos != head) {
+		size_t n = 0;
+
+		while (n < READ_BATCH && done + n < wanted && reader->pos != head) {
+			/* skip everything the writer already lapped, the sequence gap tells */
+			if (head - reader->pos > ring->mask)
+				reader->pos = head - ring->mask;
+
+			if (acpi_gpio_pps_client_ring_copy(ring, reader->pos, &evs[n]))
+				++n;
+			++reader->pos;
+		}
+
+		if (copy_to_user(buf + done * sizeof(evs[0]), evs, n * sizeof(evs[0])))
+			return -EFAULT;
+		done += n;
+
+		head = smp_load_acquire(&ring->hdr->head);
+	}
+
+	return done * sizeof(evs[0]);
+}
+
+static __poll_t acpi_gpio_pps_client_ring_poll(struct file *file, poll_table *wait)
+{
+	struct acpi_gpio_pps_client_reader *reader = file->private_data;
+	struct acpi_gpio_pps_client_ring *ring = reader->ring;
+
+	poll_wait(file, &ring->wait, wait);
+
+	if (READ_ONCE(ring->dead))
+		return EPOLLHUP;
+	if (smp_load_acquire(&ring->hdr->head) != reader->pos)
+		return EPOLLIN | EPOLLRDNORM;
+
+	return 0;
+}
+
+static int acpi_gpio_pps_client_ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct acpi_gpio_pps_client_reader *reader = file->private_data;
+	struct acpi_gpio_pps_client_ring *ring = reader->ring;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	if (vma->vm_pgoff || vma->vm_end - vma->vm_start > ring->mem_size)
+		return -EINVAL;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return remap_vmalloc_range(vma, ring->hdr, 0);
+}
+
+static const struct file_operations acpi_gpio_pps_client_ring_fops = {
+	.owner		= THIS_MODULE,
+	.open		= acpi_gpio_pps_client_ring_open,
+	.release	= acpi_gpio_pps_client_ring_close,
+	.read		= acpi_gpio_pps_client_ring_read,
+	.poll		= acpi_gpio_pps_client_ring_poll,
+	.mmap		= acpi_gpio_pps_client_ring_mmap,
+	.llseek		= no_llseek,
+};
+
+static int acpi_gpio_pps_client_ring_create(struct acpi_gpio_pps_client_data *priv,
+					    struct acpi_gpio_pps_client_device_data *client)
+{
+	struct acpi_gpio_pps_client_ring *ring;
+	u32 size = roundup_pow_of_two(min_t(u32, event_buffer, MAX_EVENT_BUFFER));
+	int err;
+
+	ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->mem_size = PAGE_ALIGN(PAGE_SIZE + size * sizeof(*ring->events));
+	ring->hdr = vmalloc_user(ring->mem_size);
+	if (!ring->hdr) {
+		kfree(ring);
+		return -ENOMEM;
+	}
+
+	kref_init(&ring->ref);
+	init_waitqueue_head(&ring->wait);
+	ring->events = (void *)ring->hdr + PAGE_SIZE;
+	ring->mask = size - 1;
+	ring->hdr->version = PPS_CLIENT_RING_VERSION;
+	ring->hdr->size = size;
+	ring->hdr->offset = PAGE_SIZE;
+
+	snprintf(ring->name, sizeof(ring->name), "%s-events", dev_name(client->pps->dev));
+	ring->misc.minor = MISC_DYNAMIC_MINOR;
+	ring->misc.name = ring->name;
+	ring->misc.fops = &acpi_gpio_pps_client_ring_fops;
+	ring->misc.parent = priv->dev;
+	ring->misc.mode = 0444;
+
+	err = misc_register(&ring->misc);
+	if (err) {
+		dev_err(priv->dev, "failed to register event device (%s)\n", ring->name);
+		kref_put(&ring->ref, acpi_gpio_pps_client_ring_release);
+		return err;
+	}
+
+	client->ring = ring;
+
+	return 0;
+}
+
+static void acpi_gpio_pps_client_ring_destroy(struct acpi_gpio_pps_client_device_data *client)
+{
+	struct acpi_gpio_pps_client_ring *ring = client->ring;
+
+	misc_deregister(&ring->misc);
+	WRITE_ONCE(ring->dead, true);
+	wake_up_interruptible(&ring->wait);
+	kref_put(&ring->ref, acpi_gpio_pps_client_ring_release);
+	client->ring = NULL;
+}
+
+/*----- echo and loopback latency -----*/
+
+static void acpi_gpio_pps_client_echo_pulse(struct acpi_gpio_pps_client_data *priv)
+{
+	gpiod_set_value(priv->echo, 1);
+	hrtimer_start(&priv->echo_timer, ns_to_ktime((u64)echo_width * NSEC_PER_USEC),
+		      HRTIMER_MODE_REL);
+}
+
+static enum hrtimer_restart acpi_gpio_pps_client_echo_off(struct hrtimer *timer)
+{
+	struct acpi_gpio_pps_client_data *priv = container_of(timer,
+							       struct acpi_gpio_pps_client_data,
+							       echo_timer);
+
+	gpiod_set_value(priv->echo, 0);
+
+	return HRTIMER_NORESTART;
+}
+
+/* called by pps_event() with the PPS source lock held, data is the client */
+static void acpi_gpio_pps_client_echo(struct pps_device *pps, int event, void *data)
+{
+	struct acpi_gpio_pps_client_device_data *client = data;
+
+	/* echoing the loopback input would feed the echo back into itself */
+	if (client == READ_ONCE(client->priv->loopback))
+		return;
+
+	/* the selftest owns the echo output until its last loopback edge is in */
+	if (delayed_work_pending(&client->priv->selftest_work))
+		return;
+
+	if ((event & PPS_CAPTUREASSERT) && (pps->params.mode & PPS_ECHOASSERT))
+		acpi_gpio_pps_client_echo_pulse(client->priv);
+}
+
+static void acpi_gpio_pps_client_latency_add(struct acpi_gpio_pps_client_data *priv, u64 delta)
+{
+	struct acpi_gpio_pps_client_latency *lat = &priv->latency;
+
+	spin_lock(&priv->latency_lock);
+	if (!lat->count || delta < lat->min)
+		lat->min = delta;
+	if (delta > lat->max)
+		lat->max = delta;
+	lat->sum += delta;
+	++lat->count;
+	++lat->hist[min_t(int, delta ? ilog2(delta) : 0, ECHO_HIST_SIZE - 1)];
+	spin_unlock(&priv->latency_lock);
+}
+
+static void acpi_gpio_pps_client_latency_reset(struct acpi_gpio_pps_client_data *priv)
+{
+	spin_lock_irq(&priv->latency_lock);
+	memset(&priv->latency, 0, sizeof(priv->latency));
+	spin_unlock_irq(&priv->latency_lock);
+}
+
+static void acpi_gpio_pps_client_selftest_work(struct work_struct *work)
+{
+	struct acpi_gpio_pps_client_data *priv = container_of(to_delayed_work(work),
+							       struct acpi_gpio_pps_client_data,
+							       selftest_work);
+
+	/* one period after the last pulse its loopback edge has arrived */
+	if (atomic_dec_if_positive(&priv->selftest_pulses) < 0) {
+		atomic64_set(&priv->echo_ref_ns, 0);
+		complete(&priv->selftest_done);
+		return;
+	}
+
+	/* the reference has to be visible before the loopback IRQ can fire */
+	atomic64_set(&priv->echo_ref_ns, ktime_get_real_ns());
+	acpi_gpio_pps_client_echo_pulse(priv);
+	schedule_delayed_work(&priv->selftest_work, msecs_to_jiffies(SELFTEST_PERIOD));
+}
+
+static void acpi_gpio_pps_client_selftest_start(struct acpi_gpio_pps_client_data *priv,
+						 unsigned int pulses)
+{
+	cancel_delayed_work_sync(&priv->selftest_work);
+	acpi_gpio_pps_client_latency_reset(priv);
+	reinit_completion(&priv->selftest_done);
+	atomic_set(&priv->selftest_pulses, pulses);
+	if (pulses)
+		schedule_delayed_work(&priv->selftest_work, 0);
+}
+
+static struct acpi_gpio_pps_client_device_data *
+acpi_gpio_pps_client_find(struct acpi_gpio_pps_client_data *priv, const char *name)
+{
+	int i;
+
+	for (i = 0; i < priv->clients; ++i)
+		if (priv->pps_client[i].pps && !strcmp(priv->pps_client[i].name, name))
+			return &priv->pps_client[i];
+
+	return NULL;
+}
+
+/*
+ * Writing the name of a PPS GPIO the echo output is wired to runs CALIBRATE_PULSES selftest
+ * pulses against it and stores the mean latency as latency_ns of that GPIO. The write returns
+ * once the calibration is done.
+ */
+static ssize_t acpi_gpio_pps_client_echo_calibrate_store(struct device *dev,
+							 struct device_attribute *attr,
+							 const char *buf, size_t count)
+{
+	struct acpi_gpio_pps_client_data *priv = dev_get_drvdata(dev);
+	struct acpi_gpio_pps_client_device_data *client;
+	char name[PPS_MAX_NAME_LEN];
+	long left;
+	u64 mean = 0;
+	ssize_t err;
+
+	if (strscpy(name, buf, sizeof(name)) < 0)
+		return -EINVAL;
+
+	client = acpi_gpio_pps_client_find(priv, strim(name));
+	if (!client)
+		return -ENODEV;
+
+	if (!mutex_trylock(&priv->selftest_lock))
+		return -EBUSY;
+
+	WRITE_ONCE(priv->loopback, client);
+	acpi_gpio_pps_client_selftest_start(priv, CALIBRATE_PULSES);
+
+	left = wait_for_completion_interruptible_timeout(&priv->selftest_done,
+							 msecs_to_jiffies(2 * CALIBRATE_PULSES *
+									  SELFTEST_PERIOD + 1000));
+	if (left <= 0) {
+		acpi_gpio_pps_client_selftest_start(priv, 0);
+		err = left ? left : -ETIMEDOUT;
+		goto unlock;
+	}
+
+	spin_lock_irq(&priv->latency_lock);
+	if (priv->latency.count)
+		mean = div64_u64(priv->latency.sum, priv->latency.count);
+	spin_unlock_irq(&priv->latency_lock);
+
+	if (!mean) {
+		err = -ENODATA;
+		goto unlock;
+	}
+
+	WRITE_ONCE(client->latency_ns, mean);
+	dev_info(priv->dev, "PPS GPIO (%s) latency calibrated to %lluns\n", client->name, mean);
+	err = count;
+
+unlock:
+	mutex_unlock(&priv->selftest_lock);
+
+	return err;
+}
+
+static struct device_attribute acpi_gpio_pps_client_echo_calibrate_dev_attr = {
+	.attr = {
+		.name = "echo_calibrate",
+		.mode = 0200,
+	},
+	.store = acpi_gpio_pps_client_echo_calibrate_store,
+};
+
+static ssize_t acpi_gpio_pps_client_echo_selftest_show(struct device *dev,
+						       struct device_attribute *attr, char *buf)
+{
+	struct acpi_gpio_pps_client_data *priv = dev_get_drvdata(dev);
+	struct acpi_gpio_pps_client_latency lat;
+	ssize_t len;
+	int i;
+
+	spin_lock_irq(&priv->latency_lock);
+	lat = priv->latency;
+	spin_unlock_irq(&priv->latency_lock);
+
+	len = sysfs_emit(buf, "pending %d\ncount %llu\nmin %llu\nmean %llu\nmax %llu\n",
+			 atomic_read(&priv->selftest_pulses), lat.count, lat.min,
+			 lat.count ? div64_u64(lat.sum, lat.count) : 0, lat.max);
+	for (i = 0; i < ECHO_HIST_SIZE; ++i)
+		if (lat.hist[i])
+			len += sysfs_emit_at(buf, len, "%llu-%llu %llu\n", 1ULL << i,
+					     (2ULL << i) - 1, lat.hist[i]);
+
+	return len;
+}
+
+static ssize_t acpi_gpio_pps_client_echo_selftest_store(struct device *dev,
+							struct device_attribute *attr,
+							const char *buf, size_t count)
+{
+	struct acpi_gpio_pps_client_data *priv = dev_get_drvdata(dev);
+	unsigned int pulses;
+	int err;
+
+	err = kstrtouint(buf, 0, &pulses);
+	if (err)
+		return err;
+
+	/* a running calibration owns the selftest */
+	if (!mutex_trylock(&priv->selftest_lock))
+		return -EBUSY;
+	acpi_gpio_pps_client_selftest_start(priv, pulses);
+	mutex_unlock(&priv->selftest_lock);
+
+	return count;
+}
+
+static struct device_attribute acpi_gpio_pps_client_echo_selftest_dev_attr = {
+	.attr = {
+		.name = "echo_selftest",
+		.mode = 0644,
+	},
+	.show = acpi_gpio_pps_client_echo_selftest_show,
+	.store = acpi_gpio_pps_client_echo_selftest_store,
+};
+
+static struct attribute *acpi_gpio_pps_client_echo_attrs[] = {
+	&acpi_gpio_pps_client_echo_selftest_dev_attr.attr,
+	&acpi_gpio_pps_client_echo_calibrate_dev_attr.attr,
+	NULL,
 };
 
+static const struct attribute_group acpi_gpio_pps_client_echo_group = {
+	.attrs = acpi_gpio_pps_client_echo_attrs,
+};
+
+static void acpi_gpio_pps_client_echo_disable(void *data)
+{
+	struct acpi_gpio_pps_client_data *priv = data;
+
+	atomic_set(&priv->selftest_pulses, 0);
+	cancel_delayed_work_sync(&priv->selftest_work);
+	hrtimer_cancel(&priv->echo_timer);
+	gpiod_set_value(priv->echo, 0);
+}
+
+static int acpi_gpio_pps_client_echo_setup(struct acpi_gpio_pps_client_data *priv)
+{
+	int err;
+
+	priv->echo = devm_gpiod_get(priv->dev, echo_gpio, GPIOD_OUT_LOW);
+	if (IS_ERR(priv->echo)) {
+		dev_err(priv->dev, "failed to request echo GPIO (%s)\n", echo_gpio);
+		return PTR_ERR(priv->echo);
+	}
+
+	/* the echo is set from hard IRQ context */
+	if (gpiod_cansleep(priv->echo)) {
+		dev_err(priv->dev, "echo GPIO (%s) can not be used from IRQ context\n",
+			echo_gpio);
+		return -EINVAL;
+	}
+
+	spin_lock_init(&priv->latency_lock);
+	mutex_init(&priv->selftest_lock);
+	init_completion(&priv->selftest_done);
+	hrtimer_init(&priv->echo_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	priv->echo_timer.function = acpi_gpio_pps_client_echo_off;
+	INIT_DELAYED_WORK(&priv->selftest_work, acpi_gpio_pps_client_selftest_work);
+
+	err = devm_add_action_or_reset(priv->dev, acpi_gpio_pps_client_echo_disable, priv);
+	if (err) {
+		dev_err(priv->dev, "failed to add echo disable action\n");
+		return err;
+	}
+
+	return devm_device_add_group(priv->dev, &acpi_gpio_pps_client_echo_group);
+}
+
+/*----- per source sysfs -----*/
+
+static ssize_t acpi_gpio_pps_client_latency_show(struct device *dev, struct device_attribute *attr,
+						 char *buf)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, latency_attr);
+
+	return sysfs_emit(buf, "%lld\n", READ_ONCE(client->latency_ns));
+}
+
+static ssize_t acpi_gpio_pps_client_latency_store(struct device *dev, struct device_attribute *attr,
+						  const char *buf, size_t count)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, latency_attr);
+	s64 latency;
+	int err;
+
+	err = kstrtos64(buf, 0, &latency);
+	if (err)
+		return err;
+
+	WRITE_ONCE(client->latency_ns, latency);
+
+	return count;
+}
+
+static u64 acpi_gpio_pps_client_counter_sum(struct acpi_gpio_pps_client_device_data *client)
+{
+	u64 sum = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		sum += local64_read(per_cpu_ptr(client->counts, cpu));
+
+	return sum;
+}
+
+static ssize_t acpi_gpio_pps_client_count_show(struct device *dev, struct device_attribute *attr,
+					       char *buf)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, count_attr);
+
+	return sysfs_emit(buf, "%llu\n", acpi_gpio_pps_client_counter_sum(client));
+}
+
+static ssize_t acpi_gpio_pps_client_frequency_show(struct device *dev,
+						   struct device_attribute *attr, char *buf)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, frequency_attr);
+	u32 millihz;
+	u64 hz = div_u64_rem(READ_ONCE(client->frequency_millihz), 1000, &millihz);
+
+	return sysfs_emit(buf, "%llu.%03u\n", hz, millihz);
+}
+
+static ssize_t acpi_gpio_pps_client_gate_show(struct device *dev, struct device_attribute *attr,
+					      char *buf)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, gate_attr);
+
+	return sysfs_emit(buf, "%u\n", READ_ONCE(client->gate_ms));
+}
+
+static ssize_t acpi_gpio_pps_client_gate_store(struct device *dev, struct device_attribute *attr,
+					       const char *buf, size_t count)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, gate_attr);
+	unsigned int gate;
+	int err;
+
+	err = kstrtouint(buf, 0, &gate);
+	if (err)
+		return err;
+	if (!gate)
+		return -EINVAL;
+
+	WRITE_ONCE(client->gate_ms, gate);
+	mod_delayed_work(system_wq, &client->gate_work, msecs_to_jiffies(gate));
+
+	return count;
+}
+
+static ssize_t acpi_gpio_pps_client_last_edge_show(struct device *dev,
+						   struct device_attribute *attr, char *buf)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(attr, struct acpi_gpio_pps_client_device_data, last_edge_attr);
+
+	return sysfs_emit(buf, "%llu\n", READ_ONCE(client->last_edge_ns));
+}
+
+static void acpi_gpio_pps_client_init_attr(struct device_attribute *attr, const char *name,
+					   umode_t mode,
+					   ssize_t (*show)(struct device *dev,
+							   struct device_attribute *attr,
+							   char *buf),
+					   ssize_t (*store)(struct device *dev,
+							    struct device_attribute *attr,
+							    const char *buf, size_t count))
+{
+	sysfs_attr_init(&attr->attr);
+	attr->attr.name = name;
+	attr->attr.mode = mode;
+	attr->show = show;
+	attr->store = store;
+}
+
+static int acpi_gpio_pps_client_add_attrs(struct acpi_gpio_pps_client_data *priv,
+					  struct acpi_gpio_pps_client_device_data *client)
+{
+	if (client->counts) {
+		acpi_gpio_pps_client_init_attr(&client->count_attr, "count", 0444,
+					       acpi_gpio_pps_client_count_show, NULL);
+		acpi_gpio_pps_client_init_attr(&client->frequency_attr, "frequency", 0444,
+					       acpi_gpio_pps_client_frequency_show, NULL);
+		acpi_gpio_pps_client_init_attr(&client->gate_attr, "gate_ms", 0644,
+					       acpi_gpio_pps_client_gate_show,
+					       acpi_gpio_pps_client_gate_store);
+		acpi_gpio_pps_client_init_attr(&client->last_edge_attr, "last_edge_ns", 0444,
+					       acpi_gpio_pps_client_last_edge_show, NULL);
+		client->attrs[0] = &client->count_attr.attr;
+		client->attrs[1] = &client->frequency_attr.attr;
+		client->attrs[2] = &client->gate_attr.attr;
+		client->attrs[3] = &client->last_edge_attr.attr;
+	} else {
+		acpi_gpio_pps_client_init_attr(&client->latency_attr, "latency_ns", 0644,
+					       acpi_gpio_pps_client_latency_show,
+					       acpi_gpio_pps_client_latency_store);
+		client->attrs[0] = &client->latency_attr.attr;
+	}
+
+	client->attr_group.name = client->name;
+	client->attr_group.attrs = client->attrs;
+
+	return devm_device_add_group(priv->dev, &client->attr_group);
+}
+
+/*----- counter mode -----*/
+
+static void acpi_gpio_pps_client_gate_work(struct work_struct *work)
+{
+	struct acpi_gpio_pps_client_device_data *client =
+		container_of(to_delayed_work(work), struct acpi_gpio_pps_client_device_data,
+			     gate_work);
+	u64 count = acpi_gpio_pps_client_counter_sum(client);
+	u64 now = ktime_get_ns();
+
+	if (now > client->gate_ns)
+		WRITE_ONCE(client->frequency_millihz,
+			   mul_u64_u64_div_u64(count - client->gate_count,
+					       (u64)NSEC_PER_SEC * MSEC_PER_SEC, now - client->gate_ns));
+
+	client->gate_count = count;
+	client->gate_ns = now;
+
+	schedule_delayed_work(&client->gate_work, msecs_to_jiffies(READ_ONCE(client->gate_ms)));
+}
+
+static irqreturn_t counter_irq_handler(int irq, void *data)
+{
+	struct acpi_gpio_pps_client_device_data *client = data;
+
+	local64_inc(this_cpu_ptr(client->counts));
+	WRITE_ONCE(client->last_edge_ns, ktime_get_mono_fast_ns());
+
+	return IRQ_HANDLED;
+}
+
+/*----- GPIO discovery -----*/
+
+static int acpi_gpio_pps_client_add_name(struct acpi_gpio_pps_client_data *priv,
+					 const char *prop, size_t len)
+{
+	const char **names;
+	char *name;
+	int i;
+
+	/* only "<name>-gpios" and "<name>-gpio" properties describe GPIOs */
+	if (len > 6 && !strncmp(prop + len - 6, "-gpios", 6))
+		len -= 6;
+	else if (len > 5 && !strncmp(prop + len - 5, "-gpio", 5))
+		len -= 5;
+	else
+		return 0;
+
+	for (i = 0; i < priv->gpios_count; ++i)
+		if (strlen(priv->gpio_names[i]) == len && !strncmp(priv->gpio_names[i], prop, len))
+			return 0;
+
+	names = devm_krealloc(priv->dev, priv->gpio_names,
+			      sizeof(*names) * (priv->gpios_count + 1), GFP_KERNEL);
+	if (!names)
+		return -ENOMEM;
+	priv->gpio_names = names;
+
+	name = devm_kzalloc(priv->dev, len + 1, GFP_KERNEL);
+	if (!name)
+		return -ENOMEM;
+	memcpy(name, prop, len);
+	priv->gpio_names[priv->gpios_count++] = name;
+
+	return 0;
+}
+
+/* walks the _DSD device properties, every entry is a package of name and value */
+static int acpi_gpio_pps_client_scan_acpi(struct acpi_gpio_pps_client_data *priv,
+					  struct acpi_device *adev)
+{
+	const union acpi_object *ao1 = adev->data.pointer;
+	int i, j, err;
+
+	if (!ao1 || ao1->type != ACPI_TYPE_PACKAGE)
+		return 0;
+
+	for (i = 0; i < ao1->package.count; ++i) {
+		const union acpi_object *ao2 = &ao1->package.elements[i];
+
+		if (ao2->type != ACPI_TYPE_PACKAGE)
+			continue;
+
+		for (j = 0; j < ao2->package.count; ++j) {
+			const union acpi_object *ao3 = &ao2->package.elements[j];
+			const union acpi_object *name;
+
+			if (ao3->type != ACPI_TYPE_PACKAGE || ao3->package.count < 2)
+				continue;
+
+			name = &ao3->package.elements[0];
+			if (name->type != ACPI_TYPE_STRING)
+				continue;
+
+			err = acpi_gpio_pps_client_add_name(priv, name->string.pointer,
+							    name->string.length);
+			if (err)
+				return err;
+		}
+	}
+
+	return 0;
+}
+
+static int acpi_gpio_pps_client_scan_swnode(struct acpi_gpio_pps_client_data *priv,
+					    const struct fwnode_handle *fwnode)
+{
+	const struct software_node *swnode = to_software_node(fwnode);
+	const struct property_entry *prop;
+	int err;
+
+	if (!swnode)
+		return 0;
+
+	for (prop = swnode->properties; prop && prop->name; ++prop) {
+		err = acpi_gpio_pps_client_add_name(priv, prop->name, strlen(prop->name));
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
+
+static int acpi_gpio_pps_client_scan_fwnode(struct acpi_gpio_pps_client_data *priv,
+					    const struct fwnode_handle *fwnode)
+{
+	if (is_acpi_device_node(fwnode))
+		return acpi_gpio_pps_client_scan_acpi(priv, to_acpi_device_node(fwnode));
+	if (is_software_node(fwnode))
+		return acpi_gpio_pps_client_scan_swnode(priv, fwnode);
+
+	return 0;
+}
+
+/*
+ * Collects the names of all GPIOs described by the firmware node of the device, which is the
+ * _DSD of MEX0001 on the real boards or a software node (secondary or primary) otherwise.
+ */
+static int acpi_gpio_pps_client_discover(struct acpi_gpio_pps_client_data *priv)
+{
+	struct fwnode_handle *fwnode = dev_fwnode(priv->dev);
+	int err;
+
+	if (!fwnode)
+		return 0;
+
+	err = acpi_gpio_pps_client_scan_fwnode(priv, fwnode);
+	if (err)
+		return err;
+
+	if (!IS_ERR_OR_NULL(fwnode->secondary))
+		return acpi_gpio_pps_client_scan_fwnode(priv, fwnode->secondary);
+
+	return 0;
+}
+
+/*----- platform driver -----*/
+
 static irqreturn_t irq_handler(int irq, void *data)
 {
 	struct acpi_gpio_pps_client_device_data *client = data;
+	struct acpi_gpio_pps_client_data *priv = client->priv;
 	struct pps_event_time ts;
+	s64 latency;
+	u64 now;
 	int rising_edge;
 
 	pps_get_ts(&ts);
-	rising_edge = gpiod_get_value(client->gpio);
+	/* sleeping GPIOs (e.g. gpio-sim) can not be read here, the IRQ only fires on rising edges */
+	rising_edge = client->cansleep ? 1 : gpiod_get_value(client->gpio);
+
+	/* latency measurements always work on the uncompensated timestamps */
+	now = timespec64_to_ns(&ts.ts_real);
+	if (client == READ_ONCE(priv->loopback) && rising_edge) {
+		u64 ref = atomic64_xchg(&priv->echo_ref_ns, 0);
+
+		if (ref && now > ref)
+			acpi_gpio_pps_client_latency_add(priv, now - ref);
+	}
+
+	latency = READ_ONCE(client->latency_ns);
+	if (latency)
+		ts.ts_real = timespec64_sub(ts.ts_real, ns_to_timespec64(latency));
+
+	trace_acpi_gpio_pps_client_edge(client->name, irq, &ts.ts_real, rising_edge, latency);
+
+	if (client->ring)
+		acpi_gpio_pps_client_ring_push(client->ring, &ts.ts_real, rising_edge ?
+					       PPS_CLIENT_EVENT_ASSERT : PPS_CLIENT_EVENT_CLEAR);
 
 	if (rising_edge)
 		pps_event(client->pps, &ts, PPS_CAPTUREASSERT, client);
@@ -55,14 +1004,20 @@ static irqreturn_t irq_handler(int irq, void *data)
 	return IRQ_HANDLED;
 }
 
+/*
+ * Registered before any IRQ gets requested, so devm frees the IRQs before this runs and no
+ * handler can touch a PPS source or event buffer that is going away.
+ */
 static void acpi_gpio_pps_client_disable(void *data)
 {
 	struct acpi_gpio_pps_client_data *priv = data;
 	struct acpi_gpio_pps_client_device_data *client;
 	int i;
 
-	for (i = 0; i < MAX_GPIOS; ++i) {
+	for (i = 0; i < priv->clients; ++i) {
 		client = &priv->pps_client[i];
+		if (client->ring)
+			acpi_gpio_pps_client_ring_destroy(client);
 		if (client->pps) {
 			pps_unregister_source(client->pps);
 			dev_info(priv->dev, "released PPS source IRQ (%d)\n", client->irq);
@@ -70,6 +1025,131 @@ static void acpi_gpio_pps_client_disable(void *data)
 	}
 }
 
+static void acpi_gpio_pps_client_counter_stop(void *data)
+{
+	struct acpi_gpio_pps_client_device_data *client = data;
+
+	cancel_delayed_work_sync(&client->gate_work);
+}
+
+static int acpi_gpio_pps_client_counter_setup(struct acpi_gpio_pps_client_data *priv,
+					      struct acpi_gpio_pps_client_device_data *client)
+{
+	int err;
+
+	client->counts = devm_alloc_percpu(priv->dev, local64_t);
+	if (!client->counts)
+		return -ENOMEM;
+
+	client->gate_ms = counter_gate ? counter_gate : COUNTER_GATE;
+	client->gate_ns = ktime_get_ns();
+	INIT_DELAYED_WORK(&client->gate_work, acpi_gpio_pps_client_gate_work);
+
+	err = acpi_gpio_pps_client_add_attrs(priv, client);
+	if (err) {
+		dev_err(priv->dev, "failed to add sysfs attributes (%s)\n", client->name);
+		return err;
+	}
+
+	err = devm_request_irq(priv->dev, client->irq, counter_irq_handler, IRQF_TRIGGER_RISING,
+			       client->name, client);
+	if (err) {
+		dev_err(priv->dev, "failed to acquire IRQ (%d)\n", client->irq);
+		return err;
+	}
+
+	/* the gate work reads the devm allocated counters, so it has to be gone before them */
+	err = devm_add_action_or_reset(priv->dev, acpi_gpio_pps_client_counter_stop, client);
+	if (err)
+		return err;
+
+	schedule_delayed_work(&client->gate_work, msecs_to_jiffies(client->gate_ms));
+
+	return 0;
+}
+
+/*
+ * The C6C GPIOs kept the source names of the old fixed table ("GPIO00" .. "GPIO07", including
+ * "GPIO04" for the "GPIO4" property), everything else is named after its firmware property.
+ */
+static void acpi_gpio_pps_client_source_name(struct acpi_gpio_pps_client_device_data *client)
+{
+	unsigned int nr;
+
+	if (!strncmp(client->name, "GPIO", 4) && !kstrtouint(client->name + 4, 10, &nr) && nr < 10)
+		snprintf(client->pps_info.name, PPS_MAX_NAME_LEN - 1, "%s.GPIO0%d", DRIVER_NAME,
+			 nr);
+	else
+		snprintf(client->pps_info.name, PPS_MAX_NAME_LEN - 1, "%s.%s", DRIVER_NAME,
+			 client->name);
+}
+
+static int acpi_gpio_pps_client_setup(struct acpi_gpio_pps_client_data *priv,
+				      struct acpi_gpio_pps_client_device_data *client,
+				      int pps_default_params, bool counter)
+{
+	int err;
+
+	client->priv = priv;
+
+	client->gpio = devm_gpiod_get(priv->dev, client->name, GPIOD_IN);
+	if (IS_ERR(client->gpio))
+		return dev_err_probe(priv->dev, PTR_ERR(client->gpio),
+				     "failed to request PPS GPIO (%s)\n", client->name);
+	client->cansleep = gpiod_cansleep(client->gpio);
+
+	err = gpiod_to_irq(client->gpio);
+	if (err < 0) {
+		dev_err(priv->dev, "failed to map GPIO (%s) to IRQ (%d)\n", client->name, err);
+		return err;
+	}
+	client->irq = err;
+
+	if (counter)
+		return acpi_gpio_pps_client_counter_setup(priv, client);
+
+	client->pps_info.mode = PPS_CAPTUREASSERT | PPS_OFFSETASSERT | PPS_CANWAIT |
+				PPS_TSFMT_TSPEC;
+	if (priv->echo) {
+		client->pps_info.mode |= PPS_ECHOASSERT;
+		client->pps_info.echo = acpi_gpio_pps_client_echo;
+	}
+	client->pps_info.owner = THIS_MODULE;
+	acpi_gpio_pps_client_source_name(client);
+
+	client->pps = pps_register_source(&client->pps_info, pps_default_params);
+	if (IS_ERR(client->pps)) {
+		dev_err(priv->dev, "failed to register IRQ (%d) as PPS source\n", client->irq);
+		err = PTR_ERR(client->pps);
+		client->pps = NULL;
+		return err;
+	}
+
+	if (event_buffer) {
+		err = acpi_gpio_pps_client_ring_create(priv, client);
+		if (err)
+			return err;
+	}
+
+	if (priv->echo && !strcmp(client->name, echo_loopback))
+		priv->loopback = client;
+
+	err = acpi_gpio_pps_client_add_attrs(priv, client);
+	if (err) {
+		dev_err(priv->dev, "failed to add sysfs attributes (%s)\n", client->name);
+		return err;
+	}
+
+	err = devm_request_irq(priv->dev, client->irq, irq_handler, IRQF_TRIGGER_RISING,
+			       client->pps_info.name, client);
+	if (err) {
+		dev_err(priv->dev, "failed to acquire IRQ (%d)\n", client->irq);
+		return err;
+	}
+
+	return 0;
+}
+
 static int acpi_gpio_pps_client_probe(struct platform_device *pdev)
 {
 	struct acpi_gpio_pps_client_data *priv;
@@ -82,78 +1162,64 @@ static int acpi_gpio_pps_client_probe(struct platform_device *pdev)
 		return -ENOMEM;
 
 	priv->dev = &pdev->dev;
+	platform_set_drvdata(pdev, priv);
 
-	for (i = 0; i < MAX_GPIOS; ++i) {
-		if (gpios_mask & (1 << i)) {
-			client = &priv->pps_client[i];
-
-			client->gpio = devm_gpiod_get(priv->dev, gpio_names[i], GPIOD_IN);
-			if (IS_ERR(client->gpio)) {
-				dev_err(priv->dev, "failed to request PPS GPIO (%s)\n",
-					gpio_names[i]);
-				err = IS_ERR(client->gpio);
-				goto fail;
-			}
-
-			err = gpiod_to_irq(client->gpio);
-			if (err < 0) {
-				dev_err(priv->dev, "failed to map GPIO (%s) to IRQ (%d)\n",
-					gpio_names[i], err);
-				goto fail;
-			}
-			client->irq = err;
-
-			client->pps_info.mode = PPS_CAPTUREASSERT | PPS_OFFSETASSERT |
-						PPS_ECHOASSERT | PPS_CANWAIT | PPS_TSFMT_TSPEC;
-			client->pps_info.owner = THIS_MODULE;
-			snprintf(client->pps_info.name, PPS_MAX_NAME_LEN - 1, "%s.GPIO0%d",
-				 DRIVER_NAME, i);
-
-			client->pps = pps_register_source(&client->pps_info, pps_default_params);
-			if (IS_ERR(client->pps)) {
-				dev_err(priv->dev, "failed to register IRQ (%d) as PPS source\n",
-					client->irq);
-				err = PTR_ERR(client->pps);
-				goto fail;
-			}
-
-			err = devm_request_irq(priv->dev, client->irq, irq_handler,
-					       IRQF_TRIGGER_RISING, client->pps_info.name, client);
-			if (err) {
-				dev_err(priv->dev, "failed to acquire IRQ (%d)\n", client->irq);
-				goto fail;
-			}
-		}
-	}
+	err = acpi_gpio_pps_client_discover(priv);
+	if (err)
+		return err;
+
+	dev_info(priv->dev, "found %d GPIOs\n", priv->gpios_count);
+
+	priv->pps_client = devm_kcalloc(priv->dev, priv->gpios_count, sizeof(*priv->pps_client),
+					GFP_KERNEL);
+	if (priv->gpios_count && !priv->pps_client)
+		return -ENOMEM;
 
 	err = devm_add_action_or_reset(priv->dev, acpi_gpio_pps_client_disable, priv);
 	if (err) {
 		dev_err(priv->dev, "failed to add disable action\n");
-		goto fail;
+		return err;
 	}
 
-	for (i = 0; i < MAX_GPIOS; ++i) {
-		if (gpios_mask & (1 << i)) {
-			client = &priv->pps_client[i];
-			dev_info(client->pps->dev, "registered IRQ (%d) as PPS source\n",
-				 client->irq);
-		}
+	if (*echo_gpio) {
+		err = acpi_gpio_pps_client_echo_setup(priv);
+		if (err)
+			return err;
+		pps_default_params |= PPS_ECHOASSERT;
 	}
 
-	platform_set_drvdata(pdev, priv);
+	for (i = 0; i < priv->gpios_count; ++i) {
+		bool counter = i < BITS_PER_LONG && (counter_mask & BIT(i));
 
-	return 0;
+		if (!counter && !all_gpios && (i >= BITS_PER_LONG || !(gpios_mask & BIT(i))))
+			continue;
 
-fail:
-	for (i = 0; i < MAX_GPIOS; ++i) {
+		/* clients is also the cleanup boundary of the disable action */
+		client = &priv->pps_client[priv->clients++];
+		client->name = priv->gpio_names[i];
+
+		err = acpi_gpio_pps_client_setup(priv, client, pps_default_params, counter);
+		if (err)
+			return err;
+	}
+
+	for (i = 0; i < priv->clients; ++i) {
 		client = &priv->pps_client[i];
-		if (client->pps) {
-			pps_unregister_source(client->pps);
-			dev_warn(priv->dev, "clean up PPS source IRQ (%d)\n", client->irq);
-		}
+		if (client->pps)
+			dev_info(client->pps->dev, "registered IRQ (%d) of GPIO (%s) as PPS source\n",
+				 client->irq, client->name);
+		else
+			dev_info(priv->dev, "registered IRQ (%d) of GPIO (%s) as edge counter\n",
+				 client->irq, client->name);
 	}
 
-	return err;
+	if (priv->loopback)
+		dev_info(priv->dev, "echo GPIO (%s) loops back to PPS GPIO (%s)\n", echo_gpio,
+			 priv->loopback->name);
+	else if (*echo_loopback)
+		dev_warn(priv->dev, "echo loopback GPIO (%s) is no PPS source\n", echo_loopback);
+
+	return 0;
 }
 
 static const struct acpi_device_id acpi_gpio_pps_client_acpi_table[] = {
@@ -161,13 +1227,21 @@ static const struct acpi_device_id acpi_gpio_pps_client_acpi_table[] = {
 	{ },
 };
 
+/* software node based instances, e.g. acpi-gpio-pps-client-sim on gpio-sim lines */
+static const struct platform_device_id acpi_gpio_pps_client_ids[] = {
+	{ DRIVER_NAME, 0 },
+	{ },
+};
+
 static struct platform_driver acpi_gpio_pps_client_driver = {
 	.driver = {
 		.name			= DRIVER_NAME,
 		.owner			= THIS_MODULE,
 		.acpi_match_table	= acpi_gpio_pps_client_acpi_table,
+		.probe_type		= PROBE_PREFER_ASYNCHRONOUS,
 	},
-	.probe	= acpi_gpio_pps_client_probe,
+	.probe		= acpi_gpio_pps_client_probe,
+	.id_table	= acpi_gpio_pps_client_ids,
 };
 module_platform_driver(acpi_gpio_pps_client_driver);
 
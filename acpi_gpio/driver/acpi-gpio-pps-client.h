@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note */
+/*
+ * acpi-gpio-pps-client - userspace interface of the pps client event buffer
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#ifndef _ACPI_GPIO_PPS_CLIENT_H
+#define _ACPI_GPIO_PPS_CLIENT_H
+
+#include <linux/types.h>
+
+#define PPS_CLIENT_RING_VERSION	1
+
+#define PPS_CLIENT_EVENT_ASSERT	0x01
+#define PPS_CLIENT_EVENT_CLEAR	0x02
+
+/*
+ * One captured edge. The sequence number counts all events of a source starting at 1, gaps
+ * in it mean the reader was too slow and events got overwritten. While the driver rewrites a
+ * slot the sequence number is 0, so mmap readers have to read it before and after copying the
+ * event and only use the copy if both reads match.
+ */
+struct pps_client_event {
+	__s64 sec;
+	__u32 nsec;
+	__u32 flags;
+	__u64 sequence;
+};
+
+/*
+ * The first page of the mmap-able buffer, the event slots start at byte offset 'offset'.
+ * 'head' is the sequence number of the last written event.
+ */
+struct pps_client_ring_header {
+	__u32 version;
+	__u32 size;
+	__u32 offset;
+	__u32 reserved;
+	__u64 head;
+};
+
+#endif
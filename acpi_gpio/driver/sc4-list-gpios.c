@@ -5,10 +5,16 @@
  */
 
 #include <linux/acpi.h>
+#include <linux/bitmap.h>
 #include <linux/gpio/consumer.h>
+#include <linux/interrupt.h>
 #include <linux/kernel.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/platform_device.h>
+#include <linux/sysfs.h>
+#include "sc4-list-gpios.h"
 
 #define DRIVER_NAME	"sc4_list_gpios"
 #define DEVICE_NODE	"MEX0001"
@@ -25,34 +31,68 @@ enum gpio_direction {
 	GPIO_DIR_OUT,
 };
 
+enum gpio_edge {
+	GPIO_EDGE_NONE,
+	GPIO_EDGE_RISING,
+	GPIO_EDGE_FALLING,
+	GPIO_EDGE_BOTH,
+};
+
+static const char *const gpio_edge_strs[] = {
+	[GPIO_EDGE_NONE]	= "none",
+	[GPIO_EDGE_RISING]	= "rising",
+	[GPIO_EDGE_FALLING]	= "falling",
+	[GPIO_EDGE_BOTH]	= "both",
+};
+
+static const unsigned long gpio_edge_flags[] = {
+	[GPIO_EDGE_NONE]	= 0,
+	[GPIO_EDGE_RISING]	= IRQF_TRIGGER_RISING,
+	[GPIO_EDGE_FALLING]	= IRQF_TRIGGER_FALLING,
+	[GPIO_EDGE_BOTH]	= IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING,
+};
+
 struct gpio_attribute {
 	struct device_attribute attr;
 	int num;
 };
 #define to_gpio_attr(x) container_of(x, struct gpio_attribute, attr)
 
-struct sc4_list_gpios_acpi_handler_info {
-	const union acpi_object *ao;
-	enum gpio_direction dir;
-};
-
-struct sc4_list_gpios_acpi_gpio_info {
-	int num;
+struct sc4_list_gpios_gpio {
+	struct gpio_attribute attr;
+	struct sc4_list_gpios_data *priv;
+	struct gpio_desc *desc;
+	char *name;
 	int idx;
+	int irq;
 	enum gpio_direction dir;
-	bool found;
+	enum gpio_edge edge;
+
+	/* per GPIO directory with pollable value */
+	struct kernfs_node *value_kn;
+	struct device_attribute value_attr;
+	struct device_attribute edge_attr;
+	struct attribute *attrs[3];
+	struct attribute_group group;
 };
 
 struct sc4_list_gpios_data {
 	struct device *dev;
-	struct gpio_attribute *gpio_attrs;
+	struct mutex lock;	/* serializes edge changes */
+	struct sc4_list_gpios_gpio *gpios;
 	struct attribute **gpio_attr_addrs;
 	struct attribute_group attr_group;
+	const struct attribute_group **gpio_groups;
+	struct gpio_desc **descs;	/* all GPIOs in table order for bulk reads */
+	void *table;			/* binary GPIO table, see sc4-list-gpios.h */
+	struct bin_attribute table_attr;
 	int gpios_count;
+	int gpios_size;
+	enum gpio_direction *crs_dirs;	/* io_restriction of every _CRS GPIO resource */
+	int crs_count;
+	int crs_size;
 };
 
-typedef int (*sc4_list_gpios_counter)(struct sc4_list_gpios_data *priv, const void *data);
-
 /*----- helper functions -----*/
 
 static const char *const sc4_list_gpios_dir_to_str(const enum gpio_direction dir)
@@ -79,18 +119,285 @@ static ssize_t sc4_list_gpios_show_gpio_number(struct device *dev, struct device
 	return sprintf(buf, "%d\n", gpio_attr->num);
 }
 
+static ssize_t sc4_list_gpios_show_value(struct device *dev, struct device_attribute *attr,
+					 char *buf)
+{
+	struct sc4_list_gpios_gpio *gpio = container_of(attr, struct sc4_list_gpios_gpio,
+							value_attr);
+	int value = gpiod_get_value_cansleep(gpio->desc);
+
+	if (value < 0)
+		return value;
+
+	return sysfs_emit(buf, "%d\n", value);
+}
+
+static ssize_t sc4_list_gpios_store_value(struct device *dev, struct device_attribute *attr,
+					  const char *buf, size_t count)
+{
+	struct sc4_list_gpios_gpio *gpio = container_of(attr, struct sc4_list_gpios_gpio,
+							value_attr);
+	bool value;
+	int err;
+
+	if (gpiod_get_direction(gpio->desc) != 0)
+		return -EPERM;
+
+	err = kstrtobool(buf, &value);
+	if (err)
+		return err;
+
+	gpiod_set_value_cansleep(gpio->desc, value);
+
+	return count;
+}
+
+/* kernfs notification is safe from any context, unlike sysfs_notify() */
+static irqreturn_t sc4_list_gpios_irq_handler(int irq, void *data)
+{
+	struct sc4_list_gpios_gpio *gpio = data;
+	struct kernfs_node *kn = READ_ONCE(gpio->value_kn);
+
+	if (!kn)
+		return IRQ_HANDLED;
+
+	sysfs_notify_dirent(kn);
+
+	return IRQ_HANDLED;
+}
+
+static ssize_t sc4_list_gpios_show_edge(struct device *dev, struct device_attribute *attr,
+					char *buf)
+{
+	struct sc4_list_gpios_gpio *gpio = container_of(attr, struct sc4_list_gpios_gpio,
+							edge_attr);
+
+	return sysfs_emit(buf, "%s\n", gpio_edge_strs[READ_ONCE(gpio->edge)]);
+}
+
+static ssize_t sc4_list_gpios_store_edge(struct device *dev, struct device_attribute *attr,
+					 const char *buf, size_t count)
+{
+	struct sc4_list_gpios_gpio *gpio = container_of(attr, struct sc4_list_gpios_gpio,
+							edge_attr);
+	struct sc4_list_gpios_data *priv = gpio->priv;
+	int edge, err = 0;
+
+	edge = sysfs_match_string(gpio_edge_strs, buf);
+	if (edge < 0)
+		return edge;
+	if (edge != GPIO_EDGE_NONE && gpio->irq < 0)
+		return -ENXIO;
+
+	mutex_lock(&priv->lock);
+
+	/* the group is visible before probe looked up the value node, nothing to notify yet */
+	if (edge != GPIO_EDGE_NONE && !gpio->value_kn) {
+		mutex_unlock(&priv->lock);
+		return -EAGAIN;
+	}
+
+	if (gpio->edge != GPIO_EDGE_NONE)
+		free_irq(gpio->irq, gpio);
+	WRITE_ONCE(gpio->edge, GPIO_EDGE_NONE);
+
+	if (edge != GPIO_EDGE_NONE) {
+		err = request_any_context_irq(gpio->irq, sc4_list_gpios_irq_handler,
+					      gpio_edge_flags[edge], gpio->name, gpio);
+		if (err >= 0) {
+			WRITE_ONCE(gpio->edge, edge);
+			err = 0;
+		}
+	}
+
+	mutex_unlock(&priv->lock);
+
+	return err ? err : count;
+}
+
+/*
+ * Reads all GPIOs at once, gpiolib groups them per chip and uses one get_multiple() access per
+ * chip where the driver supports it. The timestamp (CLOCK_MONOTONIC) is taken right before.
+ */
+static ssize_t sc4_list_gpios_show_snapshot(struct device *dev, struct device_attribute *attr,
+					    char *buf)
+{
+	struct sc4_list_gpios_data *priv = dev_get_drvdata(dev);
+	unsigned long *values;
+	ssize_t len;
+	u64 ts;
+	int i, err;
+
+	values = bitmap_zalloc(priv->gpios_count, GFP_KERNEL);
+	if (!values)
+		return -ENOMEM;
+
+	ts = ktime_get_ns();
+	err = gpiod_get_array_value_cansleep(priv->gpios_count, priv->descs, NULL, values);
+	if (err) {
+		bitmap_free(values);
+		return err;
+	}
+
+	len = sysfs_emit(buf, "%llu", ts);
+	for (i = 0; i < priv->gpios_count; ++i)
+		len += sysfs_emit_at(buf, len, " %d", test_bit(i, values) ? 1 : 0);
+	len += sysfs_emit_at(buf, len, "\n");
+
+	bitmap_free(values);
+
+	return len;
+}
+
+static struct device_attribute sc4_list_gpios_snapshot_dev_attr = {
+	.attr = {
+		.name = "snapshot",
+		.mode = 0444,
+	},
+	.show = sc4_list_gpios_show_snapshot,
+};
+
+static ssize_t sc4_list_gpios_read_table(struct file *filp, struct kobject *kobj,
+					 struct bin_attribute *attr, char *buf, loff_t off,
+					 size_t count)
+{
+	struct sc4_list_gpios_data *priv = attr->private;
+
+	/* the sysfs core already limits off + count to the attribute size */
+	memcpy(buf, priv->table + off, count);
+
+	return count;
+}
+
+static u32 sc4_list_gpios_table_dir(const enum gpio_direction dir)
+{
+	switch (dir) {
+	case GPIO_DIR_IN:
+		return SC4_GPIO_TABLE_DIR_IN;
+	case GPIO_DIR_OUT:
+		return SC4_GPIO_TABLE_DIR_OUT;
+	default:
+		return SC4_GPIO_TABLE_DIR_ANY;
+	};
+}
+
+/* the table never changes after probe, so it is built once and every read is a memcpy */
+static int sc4_list_gpios_build_table(struct sc4_list_gpios_data *priv)
+{
+	struct sc4_gpio_table_header *hdr;
+	struct sc4_gpio_table_entry *entry;
+	size_t size = sizeof(*hdr) + priv->gpios_count * sizeof(*entry);
+	int i;
+
+	priv->table = devm_kzalloc(priv->dev, size, GFP_KERNEL);
+	if (!priv->table)
+		return -ENOMEM;
+
+	hdr = priv->table;
+	hdr->magic = SC4_GPIO_TABLE_MAGIC;
+	hdr->version = SC4_GPIO_TABLE_VERSION;
+	hdr->header_size = sizeof(*hdr);
+	hdr->entry_size = sizeof(*entry);
+	hdr->count = priv->gpios_count;
+
+	entry = priv->table + sizeof(*hdr);
+	for (i = 0; i < priv->gpios_count; ++i, ++entry) {
+		strscpy(entry->name, priv->gpios[i].name, sizeof(entry->name));
+		entry->number = priv->gpios[i].attr.num;
+		entry->direction = sc4_list_gpios_table_dir(priv->gpios[i].dir);
+		entry->acpi_index = priv->gpios[i].idx;
+	}
+
+	sysfs_bin_attr_init(&priv->table_attr);
+	priv->table_attr.attr.name = "gpio_table";
+	priv->table_attr.attr.mode = 0444;
+	priv->table_attr.size = size;
+	priv->table_attr.read = sc4_list_gpios_read_table;
+	priv->table_attr.private = priv;
+
+	return 0;
+}
+
+static void sc4_list_gpios_init_gpio_group(struct sc4_list_gpios_gpio *gpio)
+{
+	sysfs_attr_init(&gpio->value_attr.attr);
+	gpio->value_attr.attr.name = "value";
+	gpio->value_attr.attr.mode = (gpio->dir == GPIO_DIR_IN) ? 0444 : 0644;
+	gpio->value_attr.show = sc4_list_gpios_show_value;
+	gpio->value_attr.store = sc4_list_gpios_store_value;
+
+	sysfs_attr_init(&gpio->edge_attr.attr);
+	gpio->edge_attr.attr.name = "edge";
+	gpio->edge_attr.attr.mode = 0644;
+	gpio->edge_attr.show = sc4_list_gpios_show_edge;
+	gpio->edge_attr.store = sc4_list_gpios_store_edge;
+
+	gpio->attrs[0] = &gpio->value_attr.attr;
+	gpio->attrs[1] = &gpio->edge_attr.attr;
+	gpio->group.name = gpio->name;
+	gpio->group.attrs = gpio->attrs;
+}
+
+static int sc4_list_gpios_get_value_kn(struct sc4_list_gpios_data *priv,
+				       struct sc4_list_gpios_gpio *gpio)
+{
+	struct kernfs_node *dir_kn, *value_kn;
+
+	dir_kn = sysfs_get_dirent(priv->dev->kobj.sd, gpio->name);
+	if (!dir_kn)
+		return -ENOENT;
+
+	value_kn = sysfs_get_dirent(dir_kn, "value");
+	sysfs_put(dir_kn);
+	if (!value_kn)
+		return -ENOENT;
+
+	/* edge stores check it under the lock, the IRQ handler without */
+	mutex_lock(&priv->lock);
+	WRITE_ONCE(gpio->value_kn, value_kn);
+	mutex_unlock(&priv->lock);
+
+	return 0;
+}
+
 /*----- ACPI <-> GPIO translation/query support -----*/
 
+/* grows the array behind *ptr by doubling, so n appends cost O(n) */
+static int sc4_list_gpios_grow(struct sc4_list_gpios_data *priv, void **ptr, int *size,
+			       int count, size_t elem_size)
+{
+	void *tmp;
+	int new_size;
+
+	if (count < *size)
+		return 0;
+
+	new_size = *size ? *size * 2 : 8;
+	tmp = devm_krealloc(priv->dev, *ptr, elem_size * new_size, GFP_KERNEL | __GFP_ZERO);
+	if (!tmp)
+		return -ENOMEM;
+
+	*ptr = tmp;
+	*size = new_size;
+
+	return 0;
+}
+
 static int sc4_list_gpios_add_gpio(struct sc4_list_gpios_data *priv, const char *gpio_name,
-				   u32 gpio_name_len, enum gpio_direction dir)
+				   u32 gpio_name_len, int idx, enum gpio_direction dir)
 {
-	struct gpio_attribute *attr;
+	struct sc4_list_gpios_gpio *gpio;
 	struct gpio_desc *desc;
 	char *name;
 	char *suffix;
 	u32 len;
 	int err;
 
+	err = sc4_list_gpios_grow(priv, (void **)&priv->gpios, &priv->gpios_size, priv->gpios_count,
+				  sizeof(*priv->gpios));
+	if (err)
+		return err;
+
 	name = devm_kzalloc(priv->dev, gpio_name_len + 1, GFP_KERNEL);
 	if (!name)
 		return -ENOMEM;
@@ -103,13 +410,13 @@ static int sc4_list_gpios_add_gpio(struct sc4_list_gpios_data *priv, const char
 
 	len = suffix - gpio_name;
 	strncpy(name, gpio_name, len);
-	attr = &priv->gpio_attrs[priv->gpios_count];
-	attr->attr.attr.name = name;
-	attr->attr.attr.mode = 0444;
-	attr->attr.show = sc4_list_gpios_show_gpio_number;
-	priv->gpio_attr_addrs[priv->gpios_count] = &attr->attr.attr;
+	gpio = &priv->gpios[priv->gpios_count];
+	gpio->name = name;
+	gpio->idx = idx;
+	gpio->dir = dir;
 
-	desc = gpiod_get(priv->dev, name, GPIOD_ASIS);
+	/* kept for the lifetime of the device, value and edge need it */
+	desc = devm_gpiod_get(priv->dev, name, GPIOD_ASIS);
 	if (IS_ERR(desc)) {
 		err = PTR_ERR(desc);
 		if (err != -EPROBE_DEFER)
@@ -117,8 +424,10 @@ static int sc4_list_gpios_add_gpio(struct sc4_list_gpios_data *priv, const char
 
 		return err;
 	}
-	attr->num = desc_to_gpio(desc);
-	gpiod_put(desc);
+	gpio->priv = priv;
+	gpio->desc = desc;
+	gpio->attr.num = desc_to_gpio(desc);
+	gpio->irq = gpiod_to_irq(desc);
 
 	if (dir != GPIO_DIR_ANY && !strncmp(name, "GPIO", 4)) {
 		name[2] = (dir == GPIO_DIR_IN) ? 'I' : 'O';
@@ -135,69 +444,67 @@ static int sc4_list_gpios_add_gpio(struct sc4_list_gpios_data *priv, const char
 	return 0;
 }
 
-static int sc4_list_gpios_add_acpi_gpios(struct sc4_list_gpios_data *priv, const void *data)
+static acpi_status sc4_list_gpios_crs_index_add(struct acpi_resource *ares, void *data)
 {
-	const struct sc4_list_gpios_acpi_handler_info *ahinfo = data;
+	struct sc4_list_gpios_data *priv = data;
+	enum gpio_direction dir;
 
-	return sc4_list_gpios_add_gpio(priv, ahinfo->ao->string.pointer, ahinfo->ao->string.length,
-				  ahinfo->dir);
-}
+	if (ares->type != ACPI_RESOURCE_TYPE_GPIO)
+		return AE_OK;
+
+	switch (ares->data.gpio.io_restriction) {
+	case ACPI_IO_RESTRICT_INPUT:
+		dir = GPIO_DIR_IN;
+		break;
+	case ACPI_IO_RESTRICT_OUTPUT:
+		dir = GPIO_DIR_OUT;
+		break;
+	default:
+		dir = GPIO_DIR_ANY;
+		break;
+	};
 
-static acpi_status sc4_list_gpios_gpio_restriction_lookup(struct acpi_resource *ares, void *data)
-{
-	struct sc4_list_gpios_acpi_gpio_info *aginfo = data;
+	if (sc4_list_gpios_grow(priv, (void **)&priv->crs_dirs, &priv->crs_size, priv->crs_count,
+				sizeof(*priv->crs_dirs)))
+		return AE_NO_MEMORY;
 
-	if (ares->type != ACPI_RESOURCE_TYPE_GPIO)
-		return 1;
-
-	if (aginfo->num++ == aginfo->idx) {
-		const struct acpi_resource_gpio *argpio = &ares->data.gpio;
-
-		switch (argpio->io_restriction) {
-		case ACPI_IO_RESTRICT_INPUT:
-			aginfo->dir = GPIO_DIR_IN;
-			break;
-		case ACPI_IO_RESTRICT_OUTPUT:
-			aginfo->dir = GPIO_DIR_OUT;
-			break;
-		default:
-			aginfo->dir = GPIO_DIR_ANY;
-			break;
-		};
-	}
+	priv->crs_dirs[priv->crs_count++] = dir;
 
 	return AE_OK;
 }
 
-static enum gpio_direction sc4_list_gpios_get_gpio_dir(struct acpi_device *adev, const int idx)
+/* a single _CRS walk indexing the direction of every GPIO resource */
+static int sc4_list_gpios_build_crs_index(struct sc4_list_gpios_data *priv,
+					  struct acpi_device *adev)
 {
-	struct sc4_list_gpios_acpi_gpio_info aginfo;
 	acpi_status status;
 
-	aginfo.num = 0;
-	aginfo.idx = idx;
-	aginfo.found = false;
+	status = acpi_walk_resources(adev->handle, METHOD_NAME__CRS, sc4_list_gpios_crs_index_add,
+				     priv);
+	if (status == AE_NO_MEMORY)
+		return -ENOMEM;
 
-	status = acpi_walk_resources(adev->handle, METHOD_NAME__CRS,
-				     sc4_list_gpios_gpio_restriction_lookup, &aginfo);
-	if (ACPI_SUCCESS(status) && aginfo.found)
-		return aginfo.dir;
+	/* without usable _CRS every GPIO simply stays "any" */
+	if (ACPI_FAILURE(status))
+		dev_warn(priv->dev, "failed to walk _CRS resources (%s)\n",
+			 acpi_format_exception(status));
 
-	return GPIO_DIR_ANY;
+	return 0;
 }
 
-static int sc4_list_gpios_count_gpios(struct sc4_list_gpios_data *priv, const void *data)
+static enum gpio_direction sc4_list_gpios_get_gpio_dir(struct sc4_list_gpios_data *priv,
+						       const int idx)
 {
-	++priv->gpios_count;
+	if (idx >= 0 && idx < priv->crs_count)
+		return priv->crs_dirs[idx];
 
-	return 0;
+	return GPIO_DIR_ANY;
 }
 
 static int sc4_list_gpios_handle_gpio(struct sc4_list_gpios_data *priv, struct acpi_device *adev,
-				 const union acpi_object *ao, sc4_list_gpios_counter func)
+				      const union acpi_object *ao)
 {
 	struct fwnode_reference_args args;
-	struct sc4_list_gpios_acpi_handler_info ahinfo;
 	int err;
 
 	if (ao->type != ACPI_TYPE_STRING || !strstr(ao->string.pointer, "-gpio"))
@@ -212,14 +519,11 @@ static int sc4_list_gpios_handle_gpio(struct sc4_list_gpios_data *priv, struct a
 		return err;
 	}
 
-	ahinfo.ao = ao;
-	ahinfo.dir = sc4_list_gpios_get_gpio_dir(adev, args.args[0]);
-
-	return func(priv, &ahinfo);
+	return sc4_list_gpios_add_gpio(priv, ao->string.pointer, ao->string.length, args.args[0],
+				       sc4_list_gpios_get_gpio_dir(priv, args.args[0]));
 }
 
-static int sc4_list_gpios_enumerate_acpi_gpios(struct sc4_list_gpios_data *priv,
-					       sc4_list_gpios_counter func)
+static int sc4_list_gpios_enumerate_acpi_gpios(struct sc4_list_gpios_data *priv)
 {
 	const union acpi_object *ao1;
 	struct acpi_device *adev = ACPI_COMPANION(priv->dev);
@@ -231,6 +535,10 @@ static int sc4_list_gpios_enumerate_acpi_gpios(struct sc4_list_gpios_data *priv,
 		return 0;
 	}
 
+	err = sc4_list_gpios_build_crs_index(priv, adev);
+	if (err)
+		return err;
+
 	ao1 = adev->data.pointer;
 	for (i = 0; i < ao1->package.count; ++i) {
 		const union acpi_object *ao2 = &ao1->package.elements[i];
@@ -246,7 +554,7 @@ static int sc4_list_gpios_enumerate_acpi_gpios(struct sc4_list_gpios_data *priv,
 
 			for (k = 0; k < ao3->package.count; ++k) {
 				err = sc4_list_gpios_handle_gpio(priv, adev,
-								 &ao3->package.elements[k], func);
+								 &ao3->package.elements[k]);
 				if (err < 0)
 					return err;
 			}
@@ -261,40 +569,74 @@ static int sc4_list_gpios_enumerate_acpi_gpios(struct sc4_list_gpios_data *priv,
 static void sc4_list_gpios_disable(void *data)
 {
 	struct sc4_list_gpios_data *priv = data;
+	struct sc4_list_gpios_gpio *gpio;
+	int i;
 
+	/* no edge store can run anymore once the groups are gone */
+	device_remove_bin_file(priv->dev, &priv->table_attr);
+	device_remove_file(priv->dev, &sc4_list_gpios_snapshot_dev_attr);
+	sysfs_remove_groups(&priv->dev->kobj, priv->gpio_groups);
 	sysfs_remove_group(&priv->dev->kobj, &priv->attr_group);
+
+	for (i = 0; i < priv->gpios_count; ++i) {
+		gpio = &priv->gpios[i];
+		if (gpio->edge != GPIO_EDGE_NONE)
+			free_irq(gpio->irq, gpio);
+		sysfs_put(gpio->value_kn);
+	}
 }
 
 static int sc4_list_gpios_probe(struct platform_device *pdev)
 {
 	struct sc4_list_gpios_data *priv;
-	int err;
+	struct gpio_attribute *attr;
+	ktime_t start = ktime_get();
+	int i, err;
 
 	priv = devm_kzalloc(&pdev->dev, sizeof(*priv), GFP_KERNEL);
 	if (!priv)
 		return -ENOMEM;
 
 	priv->dev = &pdev->dev;
+	mutex_init(&priv->lock);
 
-	err = sc4_list_gpios_enumerate_acpi_gpios(priv, sc4_list_gpios_count_gpios);
+	err = sc4_list_gpios_enumerate_acpi_gpios(priv);
 	if (err < 0)
 		return err;
 
-	dev_info(priv->dev, "found %d gpios available in %s/ACPI node:\n", priv->gpios_count,
-		 DEVICE_NODE);
-	priv->gpio_attrs = devm_kzalloc(&pdev->dev, sizeof(*priv->gpio_attrs) * priv->gpios_count,
-					GFP_KERNEL);
-	if (!priv->gpio_attrs)
-		return -ENOMEM;
-	priv->gpio_attr_addrs = devm_kzalloc(&pdev->dev, sizeof(*priv->gpio_attr_addrs) *
-					     priv->gpios_count + 1, GFP_KERNEL);
+	/* the GPIO storage does not move anymore, so the attributes can point into it now */
+	priv->gpio_attr_addrs = devm_kcalloc(&pdev->dev, priv->gpios_count + 1,
+					     sizeof(*priv->gpio_attr_addrs), GFP_KERNEL);
 	if (!priv->gpio_attr_addrs)
 		return -ENOMEM;
+	priv->gpio_groups = devm_kcalloc(&pdev->dev, priv->gpios_count + 1,
+					 sizeof(*priv->gpio_groups), GFP_KERNEL);
+	if (!priv->gpio_groups)
+		return -ENOMEM;
+	priv->descs = devm_kcalloc(&pdev->dev, priv->gpios_count, sizeof(*priv->descs),
+				   GFP_KERNEL);
+	if (priv->gpios_count && !priv->descs)
+		return -ENOMEM;
 
-	priv->gpios_count = 0;
+	for (i = 0; i < priv->gpios_count; ++i) {
+		attr = &priv->gpios[i].attr;
+		sysfs_attr_init(&attr->attr.attr);
+		attr->attr.attr.name = priv->gpios[i].name;
+		attr->attr.attr.mode = 0444;
+		attr->attr.show = sc4_list_gpios_show_gpio_number;
+		priv->gpio_attr_addrs[i] = &attr->attr.attr;
+
+		sc4_list_gpios_init_gpio_group(&priv->gpios[i]);
+		priv->gpio_groups[i] = &priv->gpios[i].group;
+		priv->descs[i] = priv->gpios[i].desc;
+	}
 
-	err = sc4_list_gpios_enumerate_acpi_gpios(priv, sc4_list_gpios_add_acpi_gpios);
-	if (err < 0)
+	dev_info(priv->dev, "found %d gpios available in %s/ACPI node (%d _CRS GPIOs) in %lldus\n",
+		 priv->gpios_count, DEVICE_NODE, priv->crs_count,
+		 ktime_us_delta(ktime_get(), start));
+
+	err = sc4_list_gpios_build_table(priv);
+	if (err)
 		return err;
 
 	priv->attr_group.name = "gpios";
@@ -303,13 +645,45 @@ static int sc4_list_gpios_probe(struct platform_device *pdev)
 	if (err)
 		return err;
 
+	platform_set_drvdata(pdev, priv);
+
+	err = sysfs_create_groups(&priv->dev->kobj, priv->gpio_groups);
+	if (err) {
+		sysfs_remove_group(&priv->dev->kobj, &priv->attr_group);
+		return err;
+	}
+
+	if (priv->gpios_count) {
+		err = device_create_file(priv->dev, &sc4_list_gpios_snapshot_dev_attr);
+		if (err) {
+			sysfs_remove_groups(&priv->dev->kobj, priv->gpio_groups);
+			sysfs_remove_group(&priv->dev->kobj, &priv->attr_group);
+			return err;
+		}
+	}
+
+	err = device_create_bin_file(priv->dev, &priv->table_attr);
+	if (err) {
+		device_remove_file(priv->dev, &sc4_list_gpios_snapshot_dev_attr);
+		sysfs_remove_groups(&priv->dev->kobj, priv->gpio_groups);
+		sysfs_remove_group(&priv->dev->kobj, &priv->attr_group);
+		return err;
+	}
+
 	err = devm_add_action_or_reset(priv->dev, sc4_list_gpios_disable, priv);
 	if (err) {
 		dev_err(&pdev->dev, "failed to add %s disable action\n", DRIVER_NAME);
 		return err;
 	}
 
-	platform_set_drvdata(pdev, priv);
+	for (i = 0; i < priv->gpios_count; ++i) {
+		err = sc4_list_gpios_get_value_kn(priv, &priv->gpios[i]);
+		if (err) {
+			dev_err(&pdev->dev, "failed to look up value of GPIO %s\n",
+				priv->gpios[i].name);
+			return err;
+		}
+	}
 
 	return 0;
 }
@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note */
+/*
+ * sc4-list-gpios - binary GPIO table layout shared with userspace
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#ifndef _SC4_LIST_GPIOS_H
+#define _SC4_LIST_GPIOS_H
+
+#include <linux/types.h>
+
+#define SC4_GPIO_TABLE_MAGIC	0x47344353	/* "SC4G" little endian */
+#define SC4_GPIO_TABLE_VERSION	1
+#define SC4_GPIO_NAME_LEN	32
+
+enum sc4_gpio_table_direction {
+	SC4_GPIO_TABLE_DIR_ANY = 0,
+	SC4_GPIO_TABLE_DIR_IN = 1,
+	SC4_GPIO_TABLE_DIR_OUT = 2,
+};
+
+/*
+ * The table starts with this header, followed by 'count' entries of 'entry_size' bytes each,
+ * beginning at byte offset 'header_size'. Readers have to use the sizes from the header, newer
+ * versions only append fields.
+ */
+struct sc4_gpio_table_header {
+	__u32 magic;
+	__u16 version;
+	__u16 header_size;
+	__u32 entry_size;
+	__u32 count;
+};
+
+struct sc4_gpio_table_entry {
+	char name[SC4_GPIO_NAME_LEN];	/* nul terminated, as used in sysfs */
+	__s32 number;			/* legacy GPIO number */
+	__u32 direction;		/* enum sc4_gpio_table_direction, from _CRS io_restriction */
+	__u32 acpi_index;		/* index of the GPIO resource in _CRS */
+	__u32 reserved;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Creates a one line gpio-sim bank, binds acpi_gpio_pps_client to it through
+# acpi-gpio-pps-client-sim and runs pps_client_sim_test on the PPS source.
+# The modules are taken from the parent directory, build them there first.
+
+ksft_skip=4
+name=pps_client_selftest
+config=/sys/kernel/config/gpio-sim
+dir=$(dirname "$0")
+modules=$(cd "$dir/.." && pwd)
+
+skip()
+{
+	echo "TAP version 13"
+	echo "1..0 # SKIP $1"
+	exit $ksft_skip
+}
+
+cleanup()
+{
+	rmmod acpi_gpio_pps_client 2>/dev/null
+	rmmod acpi_gpio_pps_client_sim 2>/dev/null
+	if [ -d "$config/$name" ]; then
+		echo 0 > "$config/$name/live"
+		rmdir "$config/$name/bank0"
+		rmdir "$config/$name"
+	fi
+}
+
+[ "$(id -u)" = 0 ] || skip "must be run as root"
+[ -f "$modules/acpi-gpio-pps-client.ko" ] || skip "acpi-gpio-pps-client.ko not built"
+[ -f "$modules/acpi-gpio-pps-client-sim.ko" ] || skip "acpi-gpio-pps-client-sim.ko not built"
+modprobe -q pps_core
+modprobe -q gpio-sim || skip "gpio-sim not available"
+[ -d "$config" ] || mount -t configfs none /sys/kernel/config 2>/dev/null
+[ -d "$config" ] || skip "gpio-sim configfs interface not found"
+
+trap cleanup EXIT
+
+mkdir "$config/$name" "$config/$name/bank0" || skip "unable to create a gpio-sim bank"
+echo 1 > "$config/$name/bank0/num_lines"
+echo "$name" > "$config/$name/bank0/label"
+echo 1 > "$config/$name/live" || skip "unable to enable the gpio-sim bank"
+
+insmod "$modules/acpi-gpio-pps-client-sim.ko" chip="$name" lines=1 || exit 1
+insmod "$modules/acpi-gpio-pps-client.ko" || exit 1
+
+pull="/sys/devices/platform/$(cat "$config/$name/dev_name")/$(cat "$config/$name/bank0/chip_name")/sim_gpio0/pull"
+pps=
+for source in /sys/class/pps/pps*; do
+	if [ "$(cat "$source/name")" = "acpi_gpio_pps_client.GPIO00" ]; then
+		pps=/dev/$(basename "$source")
+		break
+	fi
+done
+[ -n "$pps" ] || { echo "no PPS source of acpi_gpio_pps_client found"; exit 1; }
+
+"$dir/pps_client_sim_test" -d "$pps" -p "$pull" "$@"
@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * pps_client_sim_test - toggles a gpio-sim line feeding acpi_gpio_pps_client and checks the
+ * events delivered through /dev/ppsN
+ * Copyright (C) 2021 Wilken Gottwalt
+ *
+ * Every rate is one test: the line is pulled up and down <rate> times per second for the given
+ * duration while the events are fetched from the PPS device. The first (lowest) rate must not
+ * lose an edge, the higher ones are reported as benchmark and only fail on errors.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/pps.h>
+
+#define KSFT_PASS	0
+#define KSFT_FAIL	1
+#define KSFT_SKIP	4
+
+#define DEFAULT_DEVICE		"/dev/pps0"
+#define DEFAULT_RATES		"10,100,1000,5000"
+#define DEFAULT_DURATION	2000
+#define MAX_RATES		16
+
+struct toggler {
+	const char *pullpath;
+	unsigned int rate;
+	unsigned int duration_ms;
+	uint64_t generated;
+	int err;
+	volatile bool done;
+};
+
+struct result {
+	uint64_t generated;
+	uint64_t captured;
+	uint64_t delivered;
+	double seconds;
+	int64_t lat_min;
+	int64_t lat_mean;
+	int64_t lat_max;
+};
+
+static int64_t ns(const struct timespec *ts)
+{
+	return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+static void ns_to_ts(int64_t value, struct timespec *ts)
+{
+	ts->tv_sec = value / 1000000000;
+	ts->tv_nsec = value % 1000000000;
+}
+
+/* a zero timeout returns the current state without waiting for an edge */
+static int pps_fetch(int fd, struct pps_fdata *data, int64_t timeout_ns)
+{
+	memset(data, 0, sizeof(*data));
+	data->timeout.sec = timeout_ns / 1000000000;
+	data->timeout.nsec = timeout_ns % 1000000000;
+
+	return ioctl(fd, PPS_FETCH, data) < 0 ? -errno : 0;
+}
+
+static void *toggle(void *arg)
+{
+	static const char pull_up[] = "pull-up";
+	static const char pull_down[] = "pull-down";
+	struct toggler *t = arg;
+	int64_t half_period = 500000000 / t->rate;
+	struct timespec now, next;
+	int64_t end;
+	bool high = false;
+	int fd;
+
+	fd = open(t->pullpath, O_WRONLY);
+	if (fd < 0) {
+		t->err = errno;
+		t->done = true;
+		return NULL;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	end = ns(&now) + (int64_t)t->duration_ms * 1000000;
+
+	for (next = now; ns(&next) < end; ns_to_ts(ns(&next) + half_period, &next)) {
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		high = !high;
+		if ((high ? pwrite(fd, pull_up, sizeof(pull_up) - 1, 0)
+			  : pwrite(fd, pull_down, sizeof(pull_down) - 1, 0)) < 0) {
+			t->err = errno;
+			break;
+		}
+		if (high)
+			++t->generated;
+	}
+
+	if (high && pwrite(fd, pull_down, sizeof(pull_down) - 1, 0) < 0 && !t->err)
+		t->err = errno;
+	close(fd);
+	t->done = true;
+
+	return NULL;
+}
+
+static int run(int fd, const char *pullpath, unsigned int rate, unsigned int duration_ms,
+	       struct result *res)
+{
+	struct toggler t = {
+		.pullpath = pullpath,
+		.rate = rate,
+		.duration_ms = duration_ms,
+	};
+	struct timespec start, stop, now;
+	struct pps_fdata data;
+	uint32_t first_seq, last_seq;
+	int64_t lat, lat_sum = 0;
+	pthread_t thread;
+	int err;
+
+	err = pps_fetch(fd, &data, 0);
+	if (err)
+		return err;
+	first_seq = last_seq = data.info.assert_sequence;
+
+	memset(res, 0, sizeof(*res));
+	res->lat_min = INT64_MAX;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	err = pthread_create(&thread, NULL, toggle, &t);
+	if (err)
+		return -err;
+
+	while (!t.done) {
+		err = pps_fetch(fd, &data, 100000000);
+		if (err == -ETIMEDOUT || err == -EINTR)
+			continue;
+		if (err)
+			break;
+
+		/* PPS timestamps are CLOCK_REALTIME */
+		clock_gettime(CLOCK_REALTIME, &now);
+		if (data.info.assert_sequence == last_seq)
+			continue;
+		last_seq = data.info.assert_sequence;
+
+		lat = ns(&now) - ((int64_t)data.info.assert_tu.sec * 1000000000 +
+				  data.info.assert_tu.nsec);
+		if (lat < res->lat_min)
+			res->lat_min = lat;
+		if (lat > res->lat_max)
+			res->lat_max = lat;
+		lat_sum += lat;
+		++res->delivered;
+	}
+
+	pthread_join(thread, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	if (err && err != -ETIMEDOUT && err != -EINTR)
+		return err;
+	if (t.err)
+		return -t.err;
+
+	/* let the last edges settle before reading the final sequence */
+	usleep(100000);
+	err = pps_fetch(fd, &data, 0);
+	if (err)
+		return err;
+
+	res->generated = t.generated;
+	res->captured = data.info.assert_sequence - first_seq;
+	res->seconds = (ns(&stop) - ns(&start)) / 1e9;
+	res->lat_mean = res->delivered ? lat_sum / (int64_t)res->delivered : 0;
+	if (!res->delivered)
+		res->lat_min = 0;
+
+	return 0;
+}
+
+static void usage(const char *appname)
+{
+	printf("usage: %s -p <sim_gpioN/pull> [-d <pps device>] [-r <rates>] [-t <ms>]\n"
+	       "  -p  gpio-sim pull attribute of the line wired to the PPS source\n"
+	       "  -d  PPS device (default: " DEFAULT_DEVICE ")\n"
+	       "  -r  comma separated rates in Hz, the first one must not lose an edge\n"
+	       "      (default: " DEFAULT_RATES ")\n"
+	       "  -t  duration per rate in ms (default: %d)\n", appname, DEFAULT_DURATION);
+}
+
+int main(int argc, char **argv)
+{
+	const char *device = DEFAULT_DEVICE;
+	const char *pullpath = NULL;
+	char rates_arg[128] = DEFAULT_RATES;
+	unsigned int rates[MAX_RATES];
+	unsigned int duration_ms = DEFAULT_DURATION;
+	unsigned int count = 0, i, failed = 0;
+	char *tok, *end;
+	int opt, fd;
+
+	while ((opt = getopt(argc, argv, "d:p:r:t:h")) != -1) {
+		switch (opt) {
+		case 'd':
+			device = optarg;
+			break;
+		case 'p':
+			pullpath = optarg;
+			break;
+		case 'r':
+			snprintf(rates_arg, sizeof(rates_arg), "%s", optarg);
+			break;
+		case 't':
+			duration_ms = strtoul(optarg, &end, 10);
+			if (*end || !duration_ms) {
+				usage(argv[0]);
+				return KSFT_FAIL;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? KSFT_PASS : KSFT_FAIL;
+		}
+	}
+
+	for (tok = strtok(rates_arg, ","); tok && count < MAX_RATES; tok = strtok(NULL, ",")) {
+		rates[count] = strtoul(tok, &end, 10);
+		if (*end || !rates[count] || rates[count] > 500000) {
+			fprintf(stderr, "invalid rate '%s'\n", tok);
+			return KSFT_FAIL;
+		}
+		++count;
+	}
+
+	if (!pullpath || !count) {
+		usage(argv[0]);
+		return KSFT_FAIL;
+	}
+
+	printf("TAP version 13\n");
+
+	if (access(pullpath, W_OK)) {
+		printf("1..0 # SKIP %s: %s\n", pullpath, strerror(errno));
+		return KSFT_SKIP;
+	}
+
+	fd = open(device, O_RDWR);
+	if (fd < 0) {
+		printf("1..0 # SKIP %s: %s\n", device, strerror(errno));
+		return KSFT_SKIP;
+	}
+
+	printf("1..%u\n", count);
+	printf("#     rate   generated    captured   events/s  lost(irq) lost(user)"
+	       "    lat min   lat mean    lat max\n");
+
+	for (i = 0; i < count; ++i) {
+		struct result res;
+		int err = run(fd, pullpath, rates[i], duration_ms, &res);
+		int64_t lost_irq, lost_user;
+
+		if (err) {
+			printf("not ok %u rate %u Hz # %s\n", i + 1, rates[i], strerror(-err));
+			++failed;
+			continue;
+		}
+
+		lost_irq = (int64_t)res.generated - (int64_t)res.captured;
+		lost_user = (int64_t)res.captured - (int64_t)res.delivered;
+		printf("# %8u %11llu %11llu %10.1f %10lld %10lld %10lld %10lld %10lld\n", rates[i],
+		       (unsigned long long)res.generated, (unsigned long long)res.captured,
+		       res.delivered / res.seconds, (long long)lost_irq, (long long)lost_user,
+		       (long long)res.lat_min, (long long)res.lat_mean, (long long)res.lat_max);
+
+		/* only the lowest rate has to be lossless, the others measure where the path ends */
+		if (i == 0 && (lost_irq || !res.delivered)) {
+			printf("not ok %u rate %u Hz # lost %lld of %llu edges\n", i + 1, rates[i],
+			       (long long)lost_irq, (unsigned long long)res.generated);
+			++failed;
+		} else {
+			printf("ok %u rate %u Hz%s\n", i + 1, rates[i], i ? " # benchmark" : "");
+		}
+	}
+
+	close(fd);
+
+	printf("# Totals: pass:%u fail:%u\n", count - failed, failed);
+
+	return failed ? KSFT_FAIL : KSFT_PASS;
+}
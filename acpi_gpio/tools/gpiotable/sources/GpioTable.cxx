@@ -0,0 +1,119 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "GpioTable.hxx"
+
+namespace GPIO
+{
+    //--- public constructors ---
+
+    Table::Table(const std::string &path) noexcept(false)
+    : _path(path), _entries(), _version(0)
+    {
+        load();
+    }
+
+    Table::~Table() noexcept
+    {
+    }
+
+    //--- public methods ---
+
+    uint32_t Table::version() const noexcept
+    {
+        return _version;
+    }
+
+    uint32_t Table::size() const noexcept
+    {
+        return _entries.size();
+    }
+
+    const Table::Entry *Table::entries() const noexcept
+    {
+        return _entries.data();
+    }
+
+    const Table::Entry *Table::find(const std::string &name) const noexcept
+    {
+        for (const Entry &entry : _entries)
+        {
+            if (name == entry.name)
+                return &entry;
+        }
+
+        return nullptr;
+    }
+
+    std::string Table::directionName(const uint32_t direction) noexcept
+    {
+        switch (direction)
+        {
+            case SC4_GPIO_TABLE_DIR_ANY:
+                return "any";
+            case SC4_GPIO_TABLE_DIR_IN:
+                return "input";
+            case SC4_GPIO_TABLE_DIR_OUT:
+                return "output";
+            default:
+                return "undefined";
+        }
+    }
+
+    //--- protected methods ---
+
+    void Table::load() noexcept(false)
+    {
+        struct sc4_gpio_table_header header;
+        std::vector<uint8_t> buffer(4096);
+        size_t used = 0;
+        const int32_t fd = ::open(_path.c_str(), O_RDONLY);
+
+        if (fd < 0)
+            throw std::runtime_error(::strerror(errno));
+
+        // sysfs hands out binary attributes in page sized chunks, usually one read is enough
+        while (true)
+        {
+            const ssize_t result = ::read(fd, buffer.data() + used, buffer.size() - used);
+
+            if (result < 0)
+            {
+                const int32_t err = errno;
+
+                ::close(fd);
+                throw std::runtime_error(::strerror(err));
+            }
+
+            if (result == 0)
+                break;
+
+            used += result;
+            if (used == buffer.size())
+                buffer.resize(buffer.size() * 2);
+        }
+        ::close(fd);
+
+        if (used < sizeof(header))
+            throw std::runtime_error("GPIO table too short");
+
+        std::memcpy(&header, buffer.data(), sizeof(header));
+        if (header.magic != SC4_GPIO_TABLE_MAGIC)
+            throw std::runtime_error("GPIO table has wrong magic");
+        if ((header.header_size < sizeof(header)) || (header.entry_size < sizeof(Entry)) ||
+            (used < header.header_size + static_cast<size_t>(header.count) * header.entry_size))
+            throw std::runtime_error("GPIO table is truncated");
+
+        // newer table versions may have larger entries, only the known part is copied
+        _version = header.version;
+        _entries.resize(header.count);
+        for (uint32_t i = 0; i < header.count; ++i)
+        {
+            std::memcpy(&_entries[i], buffer.data() + header.header_size + i * header.entry_size,
+                        sizeof(Entry));
+            _entries[i].name[SC4_GPIO_NAME_LEN - 1] = 0;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sc4-list-gpios.h"
+
+namespace GPIO
+{
+    class Table {
+    public:
+        using Entry = struct sc4_gpio_table_entry;
+
+        //--- public constructors ---
+        Table(const std::string &path =
+              "/sys/devices/platform/MEX0001:00/gpio_table") noexcept(false);
+        Table(const Table &rhs) = delete;
+        Table(Table &&rhs) = delete;
+        virtual ~Table() noexcept;
+
+        //--- public operators ---
+        Table &operator=(const Table &rhs) = delete;
+        Table &operator=(Table &&rhs) = delete;
+
+        //--- public methods ---
+        uint32_t version() const noexcept;
+        uint32_t size() const noexcept;
+        const Entry *entries() const noexcept;
+        const Entry *find(const std::string &name) const noexcept;
+
+        static std::string directionName(const uint32_t direction) noexcept;
+
+    protected:
+        //--- protected methods ---
+        void load() noexcept(false);
+
+    private:
+        //--- private properties ---
+        std::string _path;
+        std::vector<Entry> _entries;
+        uint32_t _version;
+    };
+}
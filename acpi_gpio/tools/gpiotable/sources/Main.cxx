@@ -0,0 +1,62 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "GpioTable.hxx"
+
+static const std::string DefaultTable("/sys/devices/platform/MEX0001:00/gpio_table");
+
+void usage(const std::string &appname) noexcept
+{
+    std::cout << "usage: " << appname << "<option>\n"
+              << "options:\n"
+              << "  --help          show this help screen\n"
+              << "  --table=<path>  path to the sc4-list-gpios table (default: " << DefaultTable
+                  << ")\n"
+              << std::endl;
+}
+
+int32_t main(int32_t argc, char **argv) noexcept
+{
+    std::string path = DefaultTable;
+
+    for (int32_t i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+
+        if (arg == "--help")
+        {
+            usage(argv[0]);
+            return 0;
+        }
+
+        if ((arg.size() > 8) && (arg.substr(0, 8) == "--table="))
+        {
+            path = arg.substr(8, std::string::npos);
+            continue;
+        }
+    }
+
+    try
+    {
+        const GPIO::Table table(path);
+        const GPIO::Table::Entry *entries = table.entries();
+
+        std::cout << "table version " << table.version() << ", " << table.size() << " GPIOs"
+                  << std::endl;
+        for (uint32_t i = 0; i < table.size(); ++i)
+        {
+            std::cout << std::setw(16) << std::left << entries[i].name << std::right
+                      << " number " << std::setw(4) << entries[i].number
+                      << " acpi index " << std::setw(3) << entries[i].acpi_index
+                      << " direction " << GPIO::Table::directionName(entries[i].direction)
+                      << std::endl;
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
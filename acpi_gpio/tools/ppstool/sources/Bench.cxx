@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "Bench.hxx"
+
+namespace PPS
+{
+    //--- public constructors ---
+
+    Bench::Bench(Device &device, const std::string &pullpath) noexcept
+    : _device(device), _pullpath(pullpath), _err(0)
+    {
+    }
+
+    Bench::~Bench() noexcept
+    {
+    }
+
+    //--- public methods ---
+
+    bool Bench::run(const uint32_t rate, const uint32_t duration_ms, Result &result) noexcept
+    {
+        const struct timespec timeout = {0, 100000000};
+        std::atomic<bool> done(false);
+        int32_t toggle_err = 0;
+        uint64_t generated = 0;
+        uint64_t delivered = 0;
+        int64_t lat_min = std::numeric_limits<int64_t>::max();
+        int64_t lat_max = 0;
+        int64_t lat_sum = 0;
+        uint32_t first_seq;
+        uint32_t last_seq;
+        uint32_t final_seq;
+
+        if (!rate || !sequence(first_seq))
+            return false;
+        last_seq = first_seq;
+
+        const auto start = std::chrono::steady_clock::now();
+        std::thread toggler([&]()
+        {
+            toggle_err = toggle(rate, duration_ms, generated);
+            done = true;
+        });
+
+        while (!done)
+        {
+            struct pps_fdata data;
+            struct timespec now;
+
+            if (!_device.fetch(data, timeout))
+            {
+                const int32_t err = errno;
+
+                _device.error();
+                if ((err == ETIMEDOUT) || (err == EINTR))
+                    continue;
+
+                _err = err;
+                break;
+            }
+
+            ::clock_gettime(CLOCK_REALTIME, &now);
+            if (data.info.assert_sequence == last_seq)
+                continue;
+            last_seq = data.info.assert_sequence;
+
+            const int64_t lat = (static_cast<int64_t>(now.tv_sec) - data.info.assert_tu.sec)
+                                * 1000000000 + (now.tv_nsec - data.info.assert_tu.nsec);
+
+            lat_min = std::min(lat_min, lat);
+            lat_max = std::max(lat_max, lat);
+            lat_sum += lat;
+            ++delivered;
+        }
+
+        toggler.join();
+        const auto stop = std::chrono::steady_clock::now();
+
+        if (toggle_err && !_err)
+            _err = toggle_err;
+
+        // let the last edges settle before reading the final sequence
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (_err || !sequence(final_seq))
+            return false;
+
+        result.rate = rate;
+        result.generated = generated;
+        result.captured = final_seq - first_seq;
+        result.delivered = delivered;
+        result.seconds = std::chrono::duration<double>(stop - start).count();
+        result.latencyMin = delivered ? lat_min : 0;
+        result.latencyMean = delivered ? lat_sum / static_cast<int64_t>(delivered) : 0;
+        result.latencyMax = lat_max;
+
+        return true;
+    }
+
+    std::string Bench::error() noexcept(false)
+    {
+        if (_err)
+        {
+            const std::string tmp(strerror(_err));
+
+            _err = 0;
+
+            return tmp;
+        }
+
+        return _device.error();
+    }
+
+    //--- protected methods ---
+
+    bool Bench::sequence(uint32_t &seq) noexcept
+    {
+        const struct timespec timeout = {0, 0};
+        struct pps_fdata data;
+
+        // a zero timeout returns the current state without waiting for an edge
+        if (!_device.fetch(data, timeout))
+        {
+            _err = errno;
+            _device.error();
+            return false;
+        }
+
+        seq = data.info.assert_sequence;
+
+        return true;
+    }
+
+    int32_t Bench::toggle(const uint32_t rate, const uint32_t duration_ms, uint64_t &generated) noexcept
+    {
+        static const char PullUp[] = "pull-up";
+        static const char PullDown[] = "pull-down";
+        const auto half_period = std::chrono::nanoseconds(500000000 / rate);
+        const auto start = std::chrono::steady_clock::now();
+        const auto end = start + std::chrono::milliseconds(duration_ms);
+        const int32_t fd = ::open(_pullpath.c_str(), O_WRONLY);
+        auto next = start;
+        bool high = false;
+        int32_t err = 0;
+
+        if (fd < 0)
+            return errno;
+
+        while (next < end)
+        {
+            std::this_thread::sleep_until(next);
+
+            high = !high;
+            const ssize_t result = high ? ::pwrite(fd, PullUp, sizeof(PullUp) - 1, 0)
+                                        : ::pwrite(fd, PullDown, sizeof(PullDown) - 1, 0);
+            if (result < 0)
+            {
+                err = errno;
+                break;
+            }
+
+            if (high)
+                ++generated;
+            next += half_period;
+        }
+
+        if (high)
+            (void)::pwrite(fd, PullDown, sizeof(PullDown) - 1, 0);
+        ::close(fd);
+
+        return err;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "PPS.hxx"
+
+namespace PPS
+{
+    // drives a simulated GPIO line (gpio-sim "pull" attribute) at a given rate and measures
+    // what arrives at the PPS device wired to it
+    class Bench {
+    public:
+        struct Result {
+            uint32_t rate;          // requested rising edges per second
+            uint64_t generated;     // rising edges generated
+            uint64_t captured;      // assert events counted by the PPS core
+            uint64_t delivered;     // assert events returned by fetch()
+            double seconds;         // measured duration
+            int64_t latencyMin;     // assert timestamp to userspace latency (ns)
+            int64_t latencyMean;
+            int64_t latencyMax;
+        };
+
+        //--- public constructors ---
+        Bench(Device &device, const std::string &pullpath) noexcept;
+        Bench(const Bench &rhs) = delete;
+        Bench(Bench &&rhs) = delete;
+        virtual ~Bench() noexcept;
+
+        //--- public operators ---
+        Bench &operator=(const Bench &rhs) = delete;
+        Bench &operator=(Bench &&rhs) = delete;
+
+        //--- public methods ---
+        bool run(const uint32_t rate, const uint32_t duration_ms, Result &result) noexcept;
+        std::string error() noexcept(false);
+
+    protected:
+        //--- protected methods ---
+        bool sequence(uint32_t &seq) noexcept;
+        int32_t toggle(const uint32_t rate, const uint32_t duration_ms, uint64_t &generated) noexcept;
+
+    private:
+        //--- private properties ---
+        Device &_device;
+        std::string _pullpath;
+        int32_t _err;   // 0 = not set/unused, positive number = errno set
+    };
+}
@@ -0,0 +1,201 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "Clock.hxx"
+
+namespace PPS
+{
+    //--- public constructors ---
+
+    Clock::Clock(const std::string &name) noexcept(false)
+    : _page(nullptr), _err(0)
+    {
+        int32_t fd;
+
+        _page = map(name, false, fd, _err);
+        if (!_page)
+            throw std::runtime_error(::strerror(_err));
+    }
+
+    Clock::~Clock() noexcept
+    {
+        unmap(_page);
+    }
+
+    //--- public methods ---
+
+    bool Clock::valid() const noexcept
+    {
+        return _page && !_err;
+    }
+
+    std::string Clock::error() noexcept(false)
+    {
+        if (_err)
+        {
+            const std::string tmp(strerror(_err));
+
+            _err = 0;
+
+            return tmp;
+        }
+
+        return "";
+    }
+
+    bool Clock::now(Time &time) const noexcept
+    {
+        struct timespec raw;
+
+        if (::clock_gettime(CLOCK_MONOTONIC_RAW, &raw) < 0)
+            return false;
+
+        convert(static_cast<int64_t>(raw.tv_sec) * 1000000000 + raw.tv_nsec, time);
+
+        return true;
+    }
+
+    // maps a CLOCK_MONOTONIC_RAW value (ns) to PPS time using the current model
+    void Clock::convert(const int64_t raw, Time &time) const noexcept
+    {
+        convert(*_page, raw, time);
+    }
+
+    //--- public static methods ---
+
+    // seqlock read side, retries while the publisher is in the middle of an update
+    void Clock::convert(const ClockPage &page, const int64_t raw, Time &time) noexcept
+    {
+        uint32_t seq;
+        uint32_t edges;
+        int64_t base_raw;
+        int64_t base_pps;
+        int64_t freq;
+        int64_t err_ns;
+        int64_t drift_ppb;
+        int64_t holdover_ns;
+
+        do
+        {
+            seq = page.seq.load(std::memory_order_acquire);
+            edges = page.edges.load(std::memory_order_relaxed);
+            base_raw = page.base_raw.load(std::memory_order_relaxed);
+            base_pps = page.base_pps.load(std::memory_order_relaxed);
+            freq = page.freq.load(std::memory_order_relaxed);
+            err_ns = page.err_ns.load(std::memory_order_relaxed);
+            drift_ppb = page.drift_ppb.load(std::memory_order_relaxed);
+            holdover_ns = page.holdover_ns.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) || (seq != page.seq.load(std::memory_order_relaxed)));
+
+        const int64_t delta = raw - base_raw;
+        const int64_t age = delta < 0 ? -delta : delta;
+
+        time.ns = base_pps + delta
+                  + static_cast<int64_t>(static_cast<double>(delta) * freq / 4294967296.0);
+        time.err_ns = err_ns + static_cast<int64_t>(static_cast<double>(age) * drift_ppb / 1e9);
+
+        if (edges < 2)
+            time.status = Status::Unsynced;
+        else if (age > holdover_ns)
+            time.status = Status::Holdover;
+        else
+            time.status = Status::Locked;
+    }
+
+    // the publisher maps writable and creates the object, readers map read only; the publisher
+    // keeps fd open and locked until unmap(), so a second one fails with EBUSY instead of
+    // interleaving its updates
+    ClockPage *Clock::map(const std::string &name, const bool writable, int32_t &fd,
+                          int32_t &err) noexcept
+    {
+        void *addr;
+
+        fd = ::shm_open(name.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0)
+        {
+            err = errno;
+            return nullptr;
+        }
+
+        if (writable && (::flock(fd, LOCK_EX | LOCK_NB) < 0))
+        {
+            err = (errno == EWOULDBLOCK) ? EBUSY : errno;
+            ::close(fd);
+            fd = -1;
+            return nullptr;
+        }
+
+        if (writable && (::ftruncate(fd, sizeof(ClockPage)) < 0))
+        {
+            err = errno;
+            ::close(fd);
+            fd = -1;
+            return nullptr;
+        }
+
+        // a reader racing the publisher's ftruncate() or finding a stale object would take a
+        // SIGBUS on the first access of a short mapping
+        if (!writable)
+        {
+            struct stat st;
+
+            if (::fstat(fd, &st) < 0)
+            {
+                err = errno;
+                ::close(fd);
+                fd = -1;
+                return nullptr;
+            }
+
+            if (st.st_size < static_cast<off_t>(sizeof(ClockPage)))
+            {
+                err = EPROTO;
+                ::close(fd);
+                fd = -1;
+                return nullptr;
+            }
+        }
+
+        addr = ::mmap(nullptr, sizeof(ClockPage), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_SHARED, fd, 0);
+        err = errno;
+        if (!writable || (addr == MAP_FAILED))
+        {
+            ::close(fd);
+            fd = -1;
+        }
+
+        if (addr == MAP_FAILED)
+            return nullptr;
+
+        ClockPage *page = static_cast<ClockPage *>(addr);
+
+        if (!writable && ((page->magic.load() != ClockPage::Magic)
+                          || (page->version.load() != ClockPage::Version)))
+        {
+            ::munmap(addr, sizeof(ClockPage));
+            err = EPROTO;
+            return nullptr;
+        }
+
+        err = 0;
+
+        return page;
+    }
+
+    // closing fd releases the publisher lock
+    void Clock::unmap(ClockPage *page, const int32_t fd) noexcept
+    {
+        if (page)
+            ::munmap(page, sizeof(ClockPage));
+        if (fd > -1)
+            ::close(fd);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace PPS
+{
+    // shared memory layout of a disciplined clock, written by Discipline and read by Clock
+    //
+    //   pps time = base_pps + delta + delta * freq / 2^32 with delta = raw - base_raw
+    //   error    = err_ns + |delta| * drift_ppb / 1e9
+    //
+    // all members besides seq are only consistent between two equal even values of seq
+    struct ClockPage {
+        static const uint32_t Magic = 0x50505343;   // "PPSC"
+        static const uint32_t Version = 1;
+
+        std::atomic<uint32_t> magic;
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> seq;
+        std::atomic<uint32_t> edges;        // edges the model is fitted to
+        std::atomic<int64_t> base_raw;      // CLOCK_MONOTONIC_RAW at the last edge (ns)
+        std::atomic<int64_t> base_pps;      // PPS time at the last edge (ns since the epoch)
+        std::atomic<int64_t> freq;          // rate correction raw to PPS, 2^-32 ns per ns
+        std::atomic<int64_t> err_ns;        // error bound at the last edge
+        std::atomic<int64_t> drift_ppb;     // growth of the error bound while extrapolating
+        std::atomic<int64_t> holdover_ns;   // delta after which the model counts as stale
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the clock page needs lock-free 64 bit atomics");
+
+    // reads a disciplined clock from any process, now() costs a vDSO clock_gettime() and a few
+    // loads, no system call
+    class Clock {
+    public:
+        enum class Status {
+            Locked,     // an edge arrived within the holdover time
+            Holdover,   // extrapolating from an old model, the error bound keeps growing
+            Unsynced    // the publisher has not seen enough edges yet
+        };
+
+        struct Time {
+            int64_t ns;         // PPS time in ns since the epoch
+            int64_t err_ns;     // error bound
+            Status status;
+        };
+
+        //--- public constructors ---
+        Clock(const std::string &name = "/ppsclock") noexcept(false);
+        Clock(const Clock &rhs) = delete;
+        Clock(Clock &&rhs) = delete;
+        virtual ~Clock() noexcept;
+
+        //--- public operators ---
+        Clock &operator=(const Clock &rhs) = delete;
+        Clock &operator=(Clock &&rhs) = delete;
+
+        //--- public methods ---
+        bool valid() const noexcept;
+        std::string error() noexcept(false);
+        bool now(Time &time) const noexcept;
+        void convert(const int64_t raw, Time &time) const noexcept;
+
+        //--- public static methods ---
+        static void convert(const ClockPage &page, const int64_t raw, Time &time) noexcept;
+        static ClockPage *map(const std::string &name, const bool writable, int32_t &fd,
+                              int32_t &err) noexcept;
+        static void unmap(ClockPage *page, const int32_t fd = -1) noexcept;
+
+    private:
+        //--- private properties ---
+        ClockPage *_page;
+        int32_t _err;   // 0 = not set/unused, positive number = errno set
+    };
+}
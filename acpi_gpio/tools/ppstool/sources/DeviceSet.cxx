@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <poll.h>
+#include "DeviceSet.hxx"
+
+namespace PPS
+{
+    // sleep bounds while waiting without usable readiness
+    static const uint32_t BackoffMin_us = 100;
+    static const uint32_t BackoffMax_us = 10000;
+
+    //--- public constructors ---
+
+    DeviceSet::DeviceSet() noexcept
+    : _devices(), _failed(nullptr), _pollable(true), _backoff_us(BackoffMin_us), _err(0)
+    {
+    }
+
+    DeviceSet::~DeviceSet() noexcept
+    {
+    }
+
+    //--- public methods ---
+
+    bool DeviceSet::add(Device &device) noexcept
+    {
+        if (!device.valid())
+        {
+            _err = EBADF;
+            return false;
+        }
+
+        if (std::find(_devices.begin(), _devices.end(), &device) != _devices.end())
+        {
+            _err = EEXIST;
+            return false;
+        }
+
+        try
+        {
+            _devices.push_back(&device);
+        }
+        catch (...)
+        {
+            _err = ENOMEM;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool DeviceSet::remove(Device &device) noexcept
+    {
+        auto it = std::find(_devices.begin(), _devices.end(), &device);
+
+        if (it == _devices.end())
+        {
+            _err = ENOENT;
+            return false;
+        }
+
+        _devices.erase(it);
+        if (_failed == &device)
+            _failed = nullptr;
+
+        return true;
+    }
+
+    size_t DeviceSet::size() const noexcept
+    {
+        return _devices.size();
+    }
+
+    std::vector<int32_t> DeviceSet::fds() const noexcept(false)
+    {
+        std::vector<int32_t> result;
+
+        for (auto device : _devices)
+            result.push_back(device->fd());
+
+        return result;
+    }
+
+    std::string DeviceSet::error() noexcept(false)
+    {
+        if (_failed)
+        {
+            const std::string tmp(_failed->deviceName() + ": " + _failed->error());
+
+            _failed = nullptr;
+
+            return tmp;
+        }
+
+        if (_err)
+        {
+            const std::string tmp(strerror(_err));
+
+            _err = 0;
+
+            return tmp;
+        }
+
+        return "";
+    }
+
+    // collects the new edges of all devices, never blocks
+    bool DeviceSet::poll(std::vector<Event> &events) noexcept(false)
+    {
+        events.clear();
+
+        for (auto device : _devices)
+        {
+            Event event;
+            bool fresh = false;
+
+            if (!device->tryFetch(event.data, fresh))
+            {
+                _failed = device;
+                return false;
+            }
+
+            if (fresh)
+            {
+                event.device = device;
+                events.push_back(event);
+            }
+        }
+
+        return true;
+    }
+
+    // waits up to timeout_ms (negative = forever) until at least one device has a new edge
+    bool DeviceSet::wait(std::vector<Event> &events, const int32_t timeout_ms) noexcept(false)
+    {
+        const auto deadline = std::chrono::steady_clock::now()
+                              + std::chrono::milliseconds(std::max(timeout_ms, 0));
+
+        while (true)
+        {
+            int32_t remaining = -1;
+
+            if (!poll(events))
+                return false;
+
+            if (!events.empty())
+            {
+                _backoff_us = BackoffMin_us;
+                return true;
+            }
+
+            if (timeout_ms >= 0)
+            {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      deadline - std::chrono::steady_clock::now()).count();
+
+                if (left <= 0)
+                    return true;
+
+                remaining = static_cast<int32_t>(left);
+            }
+
+            if (!ready(remaining))
+                return false;
+        }
+    }
+
+#if __cplusplus >= 202002L
+    // resumes the coroutines whose devices got an edge or whose stop token fired
+    size_t DeviceSet::dispatch() noexcept
+    {
+        size_t resumed = 0;
+
+        // a resumed coroutine may add or remove devices, iterate over a copy
+        try
+        {
+            const std::vector<Device *> devices(_devices);
+
+            for (auto device : devices)
+            {
+                if (std::find(_devices.begin(), _devices.end(), device) == _devices.end())
+                    continue;
+
+                if (device->dispatch())
+                    ++resumed;
+            }
+        }
+        catch (...)
+        {
+            _err = ENOMEM;
+        }
+
+        return resumed;
+    }
+
+    // drives all waiting coroutines until one of them got resumed or the timeout elapsed
+    bool DeviceSet::run(const int32_t timeout_ms) noexcept
+    {
+        const auto deadline = std::chrono::steady_clock::now()
+                              + std::chrono::milliseconds(std::max(timeout_ms, 0));
+
+        while (true)
+        {
+            int32_t remaining = -1;
+
+            if (dispatch() > 0)
+            {
+                _backoff_us = BackoffMin_us;
+                return true;
+            }
+
+            if (_err)
+                return false;
+
+            if (timeout_ms >= 0)
+            {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      deadline - std::chrono::steady_clock::now()).count();
+
+                if (left <= 0)
+                    return true;
+
+                remaining = static_cast<int32_t>(left);
+            }
+
+            if (!ready(remaining))
+                return false;
+        }
+    }
+#endif
+
+    //--- protected methods ---
+
+    // blocks until the devices may have something new, the PPS core got poll support for
+    // real with Linux 6.13, older kernels report every fd as readable all the time
+    bool DeviceSet::ready(const int32_t timeout_ms) noexcept
+    {
+        if (_pollable && !_devices.empty())
+        {
+            std::vector<struct pollfd> pfds;
+
+            try
+            {
+                for (auto device : _devices)
+                    pfds.push_back({device->fd(), POLLIN, 0});
+            }
+            catch (...)
+            {
+                _err = ENOMEM;
+                return false;
+            }
+
+            const int32_t rc = ::poll(pfds.data(), pfds.size(), timeout_ms);
+
+            if (rc < 0)
+            {
+                if (errno == EINTR)
+                    return true;
+
+                _err = errno;
+                return false;
+            }
+
+            // readable without a timeout, the caller finds out whether there really was an edge
+            // and we stop trusting poll() if it keeps answering immediately
+            if (rc > 0)
+            {
+                if (_backoff_us > BackoffMin_us)
+                    _pollable = false;
+
+                _backoff_us = std::min(_backoff_us * 2, BackoffMax_us);
+            }
+
+            return true;
+        }
+
+        uint32_t sleep_us = _backoff_us;
+
+        if ((timeout_ms >= 0) && (sleep_us > static_cast<uint32_t>(timeout_ms) * 1000))
+            sleep_us = static_cast<uint32_t>(timeout_ms) * 1000;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+        _backoff_us = std::min(_backoff_us * 2, BackoffMax_us);
+
+        return true;
+    }
+}
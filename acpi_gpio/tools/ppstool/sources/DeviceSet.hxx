@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PPS.hxx"
+
+namespace PPS
+{
+    // waits for edges on several PPS devices from one thread, the coroutine API of Device is
+    // driven from here as well
+    class DeviceSet {
+    public:
+        struct Event {
+            Device *device;
+            struct pps_fdata data;
+        };
+
+        //--- public constructors ---
+        DeviceSet() noexcept;
+        DeviceSet(const DeviceSet &rhs) = delete;
+        DeviceSet(DeviceSet &&rhs) = delete;
+        virtual ~DeviceSet() noexcept;
+
+        //--- public operators ---
+        DeviceSet &operator=(const DeviceSet &rhs) = delete;
+        DeviceSet &operator=(DeviceSet &&rhs) = delete;
+
+        //--- public methods ---
+        bool add(Device &device) noexcept;
+        bool remove(Device &device) noexcept;
+        size_t size() const noexcept;
+        std::vector<int32_t> fds() const noexcept(false);
+        std::string error() noexcept(false);
+
+        bool poll(std::vector<Event> &events) noexcept(false);
+        bool wait(std::vector<Event> &events, const int32_t timeout_ms) noexcept(false);
+
+#if __cplusplus >= 202002L
+        size_t dispatch() noexcept;
+        bool run(const int32_t timeout_ms) noexcept;
+#endif
+
+    protected:
+        //--- protected methods ---
+        bool ready(const int32_t timeout_ms) noexcept;
+
+    private:
+        //--- private properties ---
+        std::vector<Device *> _devices;
+        Device *_failed;    // device whose fetch failed, its error() tells why
+        bool _pollable;     // false once poll() reported readiness without a new edge
+        uint32_t _backoff_us;
+        int32_t _err;       // 0 = not set/unused, positive number = errno set
+    };
+}
@@ -0,0 +1,214 @@
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <time.h>
+#include "Discipline.hxx"
+
+namespace PPS
+{
+    // error growth while the rate is not known yet (typical crystal tolerance) and the lower
+    // bound once it is, covering temperature wander between two edges
+    static const int64_t DriftUnknown_ppb = 100000;
+    static const int64_t DriftFloor_ppb = 50;
+
+    static int64_t nanoseconds(const struct timespec &ts) noexcept
+    {
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    //--- public constructors ---
+
+    Discipline::Discipline(const std::string &name) noexcept(false)
+    : _page(nullptr), _fd(-1), _raw(), _pps(), _count(0), _next(0), _edges(0), _err(0)
+    {
+        _page = Clock::map(name, true, _fd, _err);
+        if (!_page)
+            throw std::runtime_error(::strerror(_err));
+
+        // a publisher that died within publish() leaves an odd sequence behind
+        const uint32_t seq = _page->seq.load(std::memory_order_relaxed);
+
+        _page->seq.store((seq + 1) & ~1u, std::memory_order_relaxed);
+        publish(0, 0, 0, 0, DriftUnknown_ppb);
+        _page->version.store(ClockPage::Version, std::memory_order_relaxed);
+        _page->magic.store(ClockPage::Magic, std::memory_order_release);
+    }
+
+    // the shared memory object stays, readers see the model aging into holdover
+    Discipline::~Discipline() noexcept
+    {
+        Clock::unmap(_page, _fd);
+    }
+
+    //--- public methods ---
+
+    bool Discipline::update(const struct pps_fdata &data, Model &model) noexcept
+    {
+        Clock::Time predicted;
+        int64_t raw;
+        int64_t pps;
+        int64_t uncertainty;
+
+        if (!sample(data.info.assert_tu, raw, pps, uncertainty))
+            return false;
+
+        // a large residual against the published model means the system clock got stepped or
+        // the edge was assigned to the wrong second, the old edges are useless then
+        Clock::convert(*_page, raw, predicted);
+        model.offset_ns = _count ? pps - predicted.ns : 0;
+        if ((model.offset_ns > Step_ns) || (model.offset_ns < -Step_ns))
+        {
+            _count = 0;
+            _next = 0;
+        }
+
+        _raw[_next] = raw;
+        _pps[_next] = pps;
+        _next = (_next + 1) % Window;
+        if (_count < Window)
+            ++_count;
+        ++_edges;
+
+        // least squares fit of (pps - raw) over raw, relative to the last edge to keep the
+        // numbers small
+        const uint32_t last = (_next + Window - 1) % Window;
+        const int64_t x0 = _raw[last];
+        const int64_t y0 = _pps[last] - _raw[last];
+        double mean_x = 0.0;
+        double mean_y = 0.0;
+        double sxx = 0.0;
+        double sxy = 0.0;
+        double slope = 0.0;
+        double rms = 0.0;
+        double fitted = 0.0;
+
+        for (uint32_t i = 0; i < _count; ++i)
+        {
+            mean_x += static_cast<double>(_raw[i] - x0);
+            mean_y += static_cast<double>(_pps[i] - _raw[i] - y0);
+        }
+        mean_x /= _count;
+        mean_y /= _count;
+
+        for (uint32_t i = 0; i < _count; ++i)
+        {
+            const double dx = static_cast<double>(_raw[i] - x0) - mean_x;
+            const double dy = static_cast<double>(_pps[i] - _raw[i] - y0) - mean_y;
+
+            sxx += dx * dx;
+            sxy += dx * dy;
+        }
+
+        if (_count >= 2)
+            slope = sxy / sxx;
+        fitted = mean_y - slope * mean_x;
+
+        for (uint32_t i = 0; i < _count; ++i)
+        {
+            const double x = static_cast<double>(_raw[i] - x0);
+            const double res = static_cast<double>(_pps[i] - _raw[i] - y0)
+                               - (fitted + slope * x);
+
+            rms += res * res;
+        }
+
+        // the error bound covers the sampling window of the last edge and three sigma of the
+        // fit, the drift three sigma of the slope plus the wander floor
+        model.edges = _edges;
+        model.freq_ppb = static_cast<int64_t>(slope * 1e9);
+        if (_count >= 3)
+        {
+            rms = std::sqrt(rms / (_count - 2));
+            model.err_ns = uncertainty + static_cast<int64_t>(3.0 * rms);
+            model.drift_ppb = static_cast<int64_t>(3.0 * rms / std::sqrt(sxx) * 1e9)
+                              + DriftFloor_ppb;
+        }
+        else
+        {
+            fitted = 0.0;
+            model.err_ns = uncertainty;
+            model.drift_ppb = _count == 2 ? 20 * DriftFloor_ppb : DriftUnknown_ppb;
+        }
+
+        publish(x0, x0 + y0 + static_cast<int64_t>(fitted),
+                static_cast<int64_t>(slope * 4294967296.0), model.err_ns, model.drift_ppb);
+
+        return true;
+    }
+
+    std::string Discipline::error() noexcept(false)
+    {
+        if (_err)
+        {
+            const std::string tmp(strerror(_err));
+
+            _err = 0;
+
+            return tmp;
+        }
+
+        return "";
+    }
+
+    //--- protected methods ---
+
+    // the PPS core timestamps with CLOCK_REALTIME, the raw time of the edge is found by
+    // bracketing a realtime read with two raw reads and stepping back by the fetch latency
+    bool Discipline::sample(const struct pps_ktime &assert_tu, int64_t &raw, int64_t &pps,
+                            int64_t &uncertainty) noexcept
+    {
+        struct timespec raw_before;
+        struct timespec real;
+        struct timespec raw_after;
+
+        if ((::clock_gettime(CLOCK_MONOTONIC_RAW, &raw_before) < 0)
+            || (::clock_gettime(CLOCK_REALTIME, &real) < 0)
+            || (::clock_gettime(CLOCK_MONOTONIC_RAW, &raw_after) < 0))
+        {
+            _err = errno;
+            return false;
+        }
+
+        const int64_t edge = static_cast<int64_t>(assert_tu.sec) * 1000000000 + assert_tu.nsec;
+        const int64_t before = nanoseconds(raw_before);
+        const int64_t after = nanoseconds(raw_after);
+        const int64_t latency = nanoseconds(real) - edge;
+
+        // an edge older than a second is not the one that just arrived
+        if ((latency < 0) || (latency > 1000000000))
+        {
+            _err = EAGAIN;
+            return false;
+        }
+
+        raw = before + (after - before) / 2 - latency;
+        uncertainty = (after - before + 1) / 2;
+
+        // the pulse marks the start of a second, the system clock only has to be right to
+        // within half a second to name it
+        pps = (edge + 500000000) / 1000000000 * 1000000000;
+
+        return true;
+    }
+
+    // seqlock write side, there is only one publisher per page
+    void Discipline::publish(const int64_t base_raw, const int64_t base_pps, const int64_t freq,
+                             const int64_t err_ns, const int64_t drift_ppb) noexcept
+    {
+        const uint32_t seq = _page->seq.load(std::memory_order_relaxed);
+
+        _page->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        _page->edges.store(_count, std::memory_order_relaxed);
+        _page->base_raw.store(base_raw, std::memory_order_relaxed);
+        _page->base_pps.store(base_pps, std::memory_order_relaxed);
+        _page->freq.store(freq, std::memory_order_relaxed);
+        _page->err_ns.store(err_ns, std::memory_order_relaxed);
+        _page->drift_ppb.store(drift_ppb, std::memory_order_relaxed);
+        _page->holdover_ns.store(Holdover_ns, std::memory_order_relaxed);
+
+        _page->seq.store(seq + 2, std::memory_order_release);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <linux/pps.h>
+#include "Clock.hxx"
+
+namespace PPS
+{
+    // fits CLOCK_MONOTONIC_RAW against the PPS edges and publishes the model for Clock readers,
+    // update() has to be called right after the fetch that returned the edge
+    class Discipline {
+    public:
+        static const uint32_t Window = 16;              // edges used for the fit
+        static const int64_t Holdover_ns = 1500000000;  // one missed edge
+        static const int64_t Step_ns = 100000000;       // larger residuals restart the fit
+
+        struct Model {
+            uint32_t edges;
+            int64_t offset_ns;  // residual of the last edge against the previous model
+            int64_t freq_ppb;   // rate correction raw to PPS
+            int64_t err_ns;
+            int64_t drift_ppb;
+        };
+
+        //--- public constructors ---
+        Discipline(const std::string &name = "/ppsclock") noexcept(false);
+        Discipline(const Discipline &rhs) = delete;
+        Discipline(Discipline &&rhs) = delete;
+        virtual ~Discipline() noexcept;
+
+        //--- public operators ---
+        Discipline &operator=(const Discipline &rhs) = delete;
+        Discipline &operator=(Discipline &&rhs) = delete;
+
+        //--- public methods ---
+        bool update(const struct pps_fdata &data, Model &model) noexcept;
+        std::string error() noexcept(false);
+
+    protected:
+        //--- protected methods ---
+        bool sample(const struct pps_ktime &assert_tu, int64_t &raw, int64_t &pps,
+                    int64_t &uncertainty) noexcept;
+        void publish(const int64_t base_raw, const int64_t base_pps, const int64_t freq,
+                     const int64_t err_ns, const int64_t drift_ppb) noexcept;
+
+    private:
+        //--- private properties ---
+        ClockPage *_page;
+        int32_t _fd;            // shared memory object, locked while this publisher lives
+        int64_t _raw[Window];   // ring of edges, raw and PPS time
+        int64_t _pps[Window];
+        uint32_t _count;        // valid entries in the ring
+        uint32_t _next;
+        uint32_t _edges;
+        int32_t _err;   // 0 = not set/unused, positive number = errno set
+    };
+}
@@ -5,7 +5,14 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <sstream>
 #include <thread>
+#include <vector>
+#include "Bench.hxx"
+#include "Clock.hxx"
+#include "DeviceSet.hxx"
+#include "Discipline.hxx"
+#include "Selector.hxx"
 #include "PPS.hxx"
 
 // PPS access needs root rights
@@ -13,6 +20,8 @@
 
 using ShDevice = std::shared_ptr<PPS::Device>;
 static const std::string DefaultDevice("/dev/pps0");
+static const std::string DefaultRates("10,100,1000,5000,10000,20000");
+static const uint32_t DefaultDuration = 2000;
 
 int32_t prepare(ShDevice pps_source, struct pps_ktime &offset_assert, int &supported_modes) noexcept
 {
@@ -71,34 +80,27 @@ bool print(ShDevice pps_source, int32_t &supported_modes) noexcept
 {
     struct pps_fdata data;
     struct timespec timeout = {3, 0};
-    int32_t err = 0;
 
     while (true)
     {
-        if (supported_modes & PPS_CANWAIT)
-        {
-            err = pps_source->fetch(data, timeout);
-        }
-        else
-        {
+        if (!(supported_modes & PPS_CANWAIT))
             std::this_thread::sleep_for(std::chrono::seconds(1));
-            err = pps_source->fetch(data, timeout);
-        }
 
-        if (err < 0)
-        {
-            if (err == -EINTR)
-            {
-                std::cerr << "warn: fetch() recieved INTR signal" << std::endl;
-                continue;
-            }
+        // fetch() returns a bool, data is only valid once it succeeded
+        if (pps_source->fetch(data, timeout))
+            break;
 
-            std::cerr << "error: fetch() error " << err << '(' << strerror(errno) << ')'
-                      << std::endl;
-            return false;
+        const int32_t err = errno;
+
+        if (err == EINTR)
+        {
+            std::cerr << "warn: fetch() recieved INTR signal" << std::endl;
+            continue;
         }
 
-        break;
+        std::cerr << "error: fetch() error " << err << " (" << pps_source->error() << ')'
+                  << std::endl;
+        return false;
     }
 
     std::cout << "device " << pps_source->deviceName()
@@ -113,51 +115,480 @@ bool print(ShDevice pps_source, int32_t &supported_modes) noexcept
     return true;
 }
 
+bool bench(ShDevice pps_source, const std::string &pullpath, const std::vector<uint32_t> &rates,
+           const uint32_t duration_ms) noexcept
+{
+    PPS::Bench bench(*pps_source, pullpath);
+
+    std::cout << "    rate   generated    captured   delivered     lost(irq)    lost(user)"
+              << "    lat min   lat mean    lat max" << std::endl;
+
+    for (auto rate : rates)
+    {
+        PPS::Bench::Result result;
+
+        if (!bench.run(rate, duration_ms, result))
+        {
+            std::cerr << "error: benchmark at " << rate << " Hz failed (" << bench.error() << ')'
+                      << std::endl;
+            return false;
+        }
+
+        std::cout << std::setfill(' ')
+                  << std::setw(8) << result.rate
+                  << std::setw(12) << result.generated
+                  << std::setw(12) << result.captured
+                  << std::setw(12) << result.delivered
+                  << std::setw(14) << static_cast<int64_t>(result.generated - result.captured)
+                  << std::setw(14) << static_cast<int64_t>(result.captured - result.delivered)
+                  << std::setw(11) << result.latencyMin
+                  << std::setw(11) << result.latencyMean
+                  << std::setw(11) << result.latencyMax
+                  << "  (" << static_cast<uint64_t>(result.delivered / result.seconds)
+                  << " events/s)" << std::endl;
+    }
+
+    return true;
+}
+
+void printEdge(const PPS::Device &pps_source, const struct pps_fdata &data) noexcept
+{
+    std::cout << "device " << pps_source.deviceName()
+              << " - assert " << std::setw(10) << std::setfill('0') << data.info.assert_tu.sec << '.'
+                  << std::setw(9) << std::setfill('0') << data.info.assert_tu.nsec
+                  << " - sequence " << data.info.assert_sequence
+              << std::endl;
+}
+
+#if __cplusplus >= 202002L
+PPS::DetachedTask watch(PPS::Device &pps_source, std::stop_token token, bool &failed) noexcept
+{
+    while (true)
+    {
+        const PPS::Edge edge = co_await pps_source.nextEdge(token);
+
+        if (edge.status == PPS::Edge::Status::Cancelled)
+            co_return;
+
+        if (edge.status == PPS::Edge::Status::Error)
+        {
+            std::cerr << "error: nextEdge() failed (" << strerror(edge.err) << ')' << std::endl;
+            failed = true;
+            co_return;
+        }
+
+        printEdge(pps_source, edge.data);
+    }
+}
+
+bool async(ShDevice pps_source, const uint32_t duration_ms) noexcept
+{
+    PPS::DeviceSet set;
+    std::stop_source stop;
+    bool failed = false;
+
+    if (!set.add(*pps_source))
+    {
+        std::cerr << "error: unable to watch device (" << set.error() << ')' << std::endl;
+        return false;
+    }
+
+    // the coroutine runs until its first co_await, everything else happens in run()
+    watch(*pps_source, stop.get_token(), failed);
+
+    const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(duration_ms);
+
+    while (!failed && (std::chrono::steady_clock::now() < end))
+    {
+        if (!set.run(100))
+        {
+            std::cerr << "error: wait failed (" << set.error() << ')' << std::endl;
+            failed = true;
+        }
+    }
+
+    stop.request_stop();
+    pps_source->cancel();
+
+    return !failed;
+}
+#else
+bool async(ShDevice pps_source, const uint32_t duration_ms) noexcept
+{
+    PPS::DeviceSet set;
+    std::vector<PPS::DeviceSet::Event> events;
+
+    if (!set.add(*pps_source))
+    {
+        std::cerr << "error: unable to watch device (" << set.error() << ')' << std::endl;
+        return false;
+    }
+
+    const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(duration_ms);
+
+    // the first round only learns the current sequence numbers
+    if (!set.poll(events))
+    {
+        std::cerr << "error: fetch failed (" << set.error() << ')' << std::endl;
+        return false;
+    }
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        if (!set.wait(events, 100))
+        {
+            std::cerr << "error: wait failed (" << set.error() << ')' << std::endl;
+            return false;
+        }
+
+        for (auto &event : events)
+            printEdge(*event.device, event.data);
+    }
+
+    return true;
+}
+#endif
+
+bool discipline(ShDevice pps_source, const std::string &clockname) noexcept
+{
+    const struct timespec timeout = {3, 0};
+    std::unique_ptr<PPS::Discipline> clock;
+    uint32_t last_seq = 0;
+    bool first = true;
+
+    try
+    {
+        clock.reset(new PPS::Discipline(clockname));
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: unable to create clock " << clockname << " (" << e.what() << ')'
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "   edges     offset   freq ppb    err ns  drift ppb" << std::endl;
+
+    while (true)
+    {
+        struct pps_fdata data;
+        PPS::Discipline::Model model;
+
+        if (!pps_source->fetch(data, timeout))
+        {
+            // errno first, building the message may change it
+            const int32_t code = errno;
+            const std::string err = pps_source->error();
+
+            if (code == EINTR)
+                continue;
+
+            // an outage is no reason to stop, the published model ages into holdover and the
+            // fit picks up again with the next edge
+            if (code == ETIMEDOUT)
+            {
+                std::cerr << "warn: no edge for " << timeout.tv_sec << "s, clock in holdover"
+                          << std::endl;
+                continue;
+            }
+
+            std::cerr << "error: fetch() failed (" << err << ')' << std::endl;
+            return false;
+        }
+
+        if (!first && (data.info.assert_sequence == last_seq))
+            continue;
+        first = false;
+        last_seq = data.info.assert_sequence;
+
+        if (!clock->update(data, model))
+        {
+            std::cerr << "warn: edge skipped (" << clock->error() << ')' << std::endl;
+            continue;
+        }
+
+        std::cout << std::setfill(' ')
+                  << std::setw(8) << model.edges
+                  << std::setw(11) << model.offset_ns
+                  << std::setw(11) << model.freq_ppb
+                  << std::setw(10) << model.err_ns
+                  << std::setw(11) << model.drift_ppb << std::endl;
+    }
+
+    return true;
+}
+
+bool select(std::vector<ShDevice> &pps_sources, const std::string &clockname) noexcept
+{
+    PPS::DeviceSet set;
+    PPS::Selector selector;
+    std::unique_ptr<PPS::Discipline> clock;
+    std::vector<PPS::DeviceSet::Event> events;
+
+    for (auto &pps_source : pps_sources)
+    {
+        if (!set.add(*pps_source))
+        {
+            std::cerr << "error: unable to watch device " << pps_source->deviceName() << " ("
+                      << set.error() << ')' << std::endl;
+            return false;
+        }
+
+        // the set already refused duplicates, so only the allocation can fail here
+        if (!selector.add(*pps_source))
+        {
+            std::cerr << "error: unable to score device " << pps_source->deviceName() << " ("
+                      << strerror(ENOMEM) << ')' << std::endl;
+            return false;
+        }
+    }
+
+    if (!clockname.empty())
+    {
+        try
+        {
+            clock.reset(new PPS::Discipline(clockname));
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "error: unable to create clock " << clockname << " (" << e.what()
+                      << ')' << std::endl;
+            return false;
+        }
+    }
+
+    // the first round only learns the current sequence numbers
+    if (!set.poll(events))
+    {
+        std::cerr << "error: fetch failed (" << set.error() << ')' << std::endl;
+        return false;
+    }
+
+    while (true)
+    {
+        PPS::Selector::Decision decision;
+        const int64_t remaining = selector.remaining_ms();
+
+        if (!set.wait(events, remaining < 0 ? 1000 : static_cast<int32_t>(remaining)))
+        {
+            std::cerr << "error: wait failed (" << set.error() << ')' << std::endl;
+            return false;
+        }
+
+        for (auto &event : events)
+            selector.edge(*event.device, event.data);
+
+        if (!selector.decide(decision))
+            continue;
+
+        if (decision.previous != decision.device)
+            std::cout << "select: " << decision.device->deviceName() << " (was "
+                      << (decision.previous ? decision.previous->deviceName() : "none") << ')'
+                      << std::endl;
+
+        printEdge(*decision.device, decision.data);
+
+        if (clock)
+        {
+            PPS::Discipline::Model model;
+
+            if (!clock->update(decision.data, model))
+                std::cerr << "warn: edge skipped (" << clock->error() << ')' << std::endl;
+        }
+
+        for (auto &source : selector.sources())
+            std::cout << "  " << (source.device == decision.device ? '*' : ' ')
+                      << std::setfill(' ') << std::setw(16) << source.device->deviceName()
+                      << " jitter " << std::setw(9) << static_cast<int64_t>(source.jitter_ns)
+                      << " gaps " << std::setw(5) << std::fixed << std::setprecision(3)
+                          << source.gap_rate
+                      << " disagree " << std::setw(9)
+                          << static_cast<int64_t>(source.disagreement_ns)
+                      << " score " << std::setw(9) << static_cast<int64_t>(source.score)
+                      << std::endl;
+    }
+
+    return true;
+}
+
+bool now(const std::string &clockname) noexcept
+{
+    static const char *Status[] = {"locked", "holdover", "unsynced"};
+    static const uint32_t Calls = 1000000;
+    std::unique_ptr<PPS::Clock> clock;
+    PPS::Clock::Time time;
+
+    try
+    {
+        clock.reset(new PPS::Clock(clockname));
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: unable to open clock " << clockname << " (" << e.what() << ')'
+                  << std::endl;
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < Calls; ++i)
+        clock->now(time);
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "clock " << clockname
+              << " - now " << time.ns / 1000000000 << '.' << std::setw(9) << std::setfill('0')
+                  << time.ns % 1000000000
+              << " - error " << time.err_ns << " ns"
+              << " - " << Status[static_cast<int32_t>(time.status)]
+              << " - " << ns / Calls << " ns per now()" << std::endl;
+
+    return true;
+}
+
 void usage(const std::string &appname) noexcept
 {
     std::cout << "usage: " << appname << "<option>\n"
               << "options:\n"
               << "  --help          show this help screen\n"
-              << "  --device=<dev>  path to PPS device (default: " << DefaultDevice << ")\n"
+              << "  --device=<dev>  path to PPS device (default: " << DefaultDevice << "), given\n"
+              << "                  more than once ppstool selects the best source every second\n"
+              << "  --bench=<path>  toggle the gpio-sim pull attribute <path> wired to the PPS\n"
+              << "                  device and report event rates, losses and latencies (ns)\n"
+              << "  --rates=<list>  comma separated benchmark rates in Hz (default: "
+                  << DefaultRates << ")\n"
+              << "  --duration=<ms> benchmark duration per rate (default: " << DefaultDuration
+                  << ")\n"
+              << "  --async=<ms>    print edges for <ms> using the non-blocking API"
+#if __cplusplus >= 202002L
+                  << " (coroutine)"
+#endif
+                  << "\n"
+              << "  --discipline=<name> publish a clock disciplined by the PPS device in the\n"
+              << "                  shared memory object <name> (e.g. /ppsclock)\n"
+              << "  --now=<name>    read the disciplined clock <name> and time now()\n"
               << std::endl;
 }
 
 int32_t main(int32_t argc, char **argv) noexcept
 {
-    std::string devname = DefaultDevice;
+    std::vector<std::string> devnames;
+    std::string pullpath;
+    std::string rates = DefaultRates;
+    std::vector<uint32_t> ratelist;
+    uint32_t duration = DefaultDuration;
+    uint32_t async_ms = 0;
+    std::string disciplined;
+    std::string clockname;
+    std::vector<ShDevice> devices;
     ShDevice pps;
     struct pps_ktime offset = {0, 0, 0};
     int32_t modes = 0;
 
-    for (int32_t i = 1; i < argc; ++i)
+    try
     {
-        std::string arg(argv[i]);
-
-        if (arg == "--help")
+        for (int32_t i = 1; i < argc; ++i)
         {
-            usage(argv[0]);
-            return 0;
-        }
+            std::string arg(argv[i]);
 
-        if ((arg.size() > 9) && (arg.substr(0, 9) == "--device="))
-        {
-            devname = arg.substr(9, std::string::npos);
-            continue;
+            if (arg == "--help")
+            {
+                usage(argv[0]);
+                return 0;
+            }
+
+            if ((arg.size() > 9) && (arg.substr(0, 9) == "--device="))
+            {
+                devnames.push_back(arg.substr(9, std::string::npos));
+                continue;
+            }
+
+            if ((arg.size() > 8) && (arg.substr(0, 8) == "--bench="))
+            {
+                pullpath = arg.substr(8, std::string::npos);
+                continue;
+            }
+
+            if ((arg.size() > 8) && (arg.substr(0, 8) == "--rates="))
+            {
+                rates = arg.substr(8, std::string::npos);
+                continue;
+            }
+
+            if ((arg.size() > 11) && (arg.substr(0, 11) == "--duration="))
+            {
+                duration = std::stoul(arg.substr(11, std::string::npos));
+                continue;
+            }
+
+            if ((arg.size() > 8) && (arg.substr(0, 8) == "--async="))
+            {
+                async_ms = std::stoul(arg.substr(8, std::string::npos));
+                continue;
+            }
+
+            if ((arg.size() > 13) && (arg.substr(0, 13) == "--discipline="))
+            {
+                disciplined = arg.substr(13, std::string::npos);
+                continue;
+            }
+
+            if ((arg.size() > 6) && (arg.substr(0, 6) == "--now="))
+            {
+                clockname = arg.substr(6, std::string::npos);
+                continue;
+            }
         }
-    }
 
-    try
-    {
-        pps = std::make_shared<PPS::Device>(devname);
+        std::istringstream list(rates);
+        std::string rate;
+
+        while (std::getline(list, rate, ','))
+            ratelist.push_back(std::stoul(rate));
     }
     catch (std::exception &e)
     {
-        std::cerr << "error: " << e.what() << std::endl;
+        std::cerr << "error: invalid option value (" << e.what() << ")\n" << std::endl;
+        usage(argv[0]);
         return 1;
     }
 
-    if (!prepare(pps, offset, modes))
-        return 1;
+    if (!clockname.empty())
+        return now(clockname) ? 0 : 1;
+
+    if (devnames.empty())
+        devnames.push_back(DefaultDevice);
+
+    for (auto &devname : devnames)
+    {
+        try
+        {
+            pps = std::make_shared<PPS::Device>(devname);
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "error: " << devname << ": " << e.what() << std::endl;
+            return 1;
+        }
+
+        if (!prepare(pps, offset, modes))
+            return 1;
+
+        devices.push_back(pps);
+    }
+
+    if (devices.size() > 1)
+        return select(devices, disciplined) ? 0 : 1;
+
+    if (!pullpath.empty())
+        return bench(pps, pullpath, ratelist, duration) ? 0 : 1;
+
+    if (async_ms)
+        return async(pps, async_ms) ? 0 : 1;
+
+    if (!disciplined.empty())
+        return discipline(pps, disciplined) ? 0 : 1;
 
     while (true)
     {
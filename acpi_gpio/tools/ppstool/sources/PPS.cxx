@@ -13,7 +13,11 @@ namespace PPS
     //--- public constructors ---
 
     Device::Device(const std::string &devname) noexcept(false)
-    : _devname(devname), _fd(-1), _err(0)
+    : _devname(devname), _fd(-1), _err(0), _assertSequence(0), _clearSequence(0),
+      _sequenceValid(false)
+#if __cplusplus >= 202002L
+      , _awaiter(nullptr)
+#endif
     {
         if (!open())
             throw std::runtime_error(::strerror(errno));
@@ -50,6 +54,13 @@ namespace PPS
         return _devname;
     }
 
+    // the PPS core reported every file descriptor as readable before Linux 6.13, so readiness
+    // of this fd only means "maybe", tryFetch() tells for sure
+    int32_t Device::fd() const noexcept
+    {
+        return _fd;
+    }
+
     bool Device::parameters(struct pps_kparams &params) noexcept
     {
         if (valid())
@@ -107,6 +118,7 @@ namespace PPS
         {
             struct pps_fdata tmp_fdata;
 
+            tmp_fdata.timeout.flags = 0;
             tmp_fdata.timeout.sec = timeout.tv_sec;
             tmp_fdata.timeout.nsec = timeout.tv_nsec;
             if (::ioctl(_fd, PPS_FETCH, &tmp_fdata) > -1)
@@ -121,6 +133,146 @@ namespace PPS
         return false;
     }
 
+    // never blocks, fresh tells whether the sequence numbers changed since the last call
+    bool Device::tryFetch(struct pps_fdata &fdata, bool &fresh) noexcept
+    {
+        const struct timespec no_wait = {0, 0};
+        struct pps_fdata tmp_fdata;
+
+        if (!fetch(tmp_fdata, no_wait))
+            return false;
+
+        fresh = !_sequenceValid || (tmp_fdata.info.assert_sequence != _assertSequence)
+                || (tmp_fdata.info.clear_sequence != _clearSequence);
+        _assertSequence = tmp_fdata.info.assert_sequence;
+        _clearSequence = tmp_fdata.info.clear_sequence;
+        _sequenceValid = true;
+        fdata = tmp_fdata;
+
+        return true;
+    }
+
+#if __cplusplus >= 202002L
+    Device::EdgeAwaiter Device::nextEdge(std::stop_token token) noexcept
+    {
+        return EdgeAwaiter(*this, token);
+    }
+
+    // resumes the waiting coroutine if its edge arrived, DeviceSet calls it
+    bool Device::dispatch() noexcept
+    {
+        EdgeAwaiter *const awaiter = pending();
+        struct pps_fdata data;
+        bool fresh = false;
+
+        if (!awaiter)
+            return false;
+
+        // the awaiter is only touched once it is released, a stop request may have won meanwhile
+        if (!tryFetch(data, fresh))
+        {
+            const int32_t err = _err;
+
+            _err = 0;
+            if (!release(awaiter))
+                return false;
+
+            awaiter->complete(Edge::Status::Error, err);
+            return true;
+        }
+
+        if (!fresh || !release(awaiter))
+            return false;
+
+        awaiter->_edge.data = data;
+        awaiter->complete(Edge::Status::Ok, 0);
+
+        return true;
+    }
+
+    void Device::cancel() noexcept
+    {
+        EdgeAwaiter *const awaiter = pending();
+
+        if (awaiter && release(awaiter))
+            awaiter->complete(Edge::Status::Cancelled, 0);
+    }
+
+    //--- EdgeAwaiter ---
+
+    Device::EdgeAwaiter::EdgeAwaiter(Device &device, std::stop_token token) noexcept
+    : _device(device), _token(token), _handle(), _edge(), _state(State::Waiting), _stopCallback()
+    {
+    }
+
+    // the first call only learns the current sequence numbers, it never reports an old edge
+    bool Device::EdgeAwaiter::await_ready() noexcept
+    {
+        if (_device.pending())
+        {
+            _edge.status = Edge::Status::Error;
+            _edge.err = EBUSY;
+            return true;
+        }
+
+        if (_token.stop_requested())
+        {
+            _edge.status = Edge::Status::Cancelled;
+            return true;
+        }
+
+        bool fresh = false;
+        const bool known = _device._sequenceValid;
+
+        if (!_device.tryFetch(_edge.data, fresh))
+        {
+            _edge.status = Edge::Status::Error;
+            _edge.err = _device._err;
+            _device._err = 0;
+            return true;
+        }
+
+        _edge.status = Edge::Status::Ok;
+
+        return fresh && known;
+    }
+
+    // false keeps the coroutine running, the awaiter got completed before it was suspended
+    bool Device::EdgeAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        State expected = State::Waiting;
+
+        _handle = handle;
+        _device.attach(this);
+
+        // runs the callback right here if the stop was already requested
+        _stopCallback.emplace(_token, StopRequest{this});
+
+        return _state.compare_exchange_strong(expected, State::Suspended);
+    }
+
+    Edge Device::EdgeAwaiter::await_resume() noexcept
+    {
+        return _edge;
+    }
+
+    // the caller released the awaiter from its device, so nobody else completes it
+    void Device::EdgeAwaiter::complete(const Edge::Status status, const int32_t err) noexcept
+    {
+        _edge.status = status;
+        _edge.err = err;
+
+        if (_state.exchange(State::Completed) == State::Suspended)
+            _handle.resume();
+    }
+
+    void Device::EdgeAwaiter::StopRequest::operator()() noexcept
+    {
+        if (awaiter->_device.release(awaiter))
+            awaiter->complete(Edge::Status::Cancelled, 0);
+    }
+#endif
+
     //--- protected methods ---
 
     bool Device::open() noexcept
@@ -155,4 +307,35 @@ namespace PPS
 
         return (result == 0) ? true : false;
     }
+
+#if __cplusplus >= 202002L
+    //--- private methods ---
+
+    Device::EdgeAwaiter *Device::pending() noexcept
+    {
+        std::lock_guard<std::mutex> lock(_awaiterLock);
+
+        return _awaiter;
+    }
+
+    void Device::attach(EdgeAwaiter *awaiter) noexcept
+    {
+        std::lock_guard<std::mutex> lock(_awaiterLock);
+
+        _awaiter = awaiter;
+    }
+
+    // only one of dispatch(), cancel() and the stop callback wins the awaiter
+    bool Device::release(EdgeAwaiter *awaiter) noexcept
+    {
+        std::lock_guard<std::mutex> lock(_awaiterLock);
+
+        if (_awaiter != awaiter)
+            return false;
+
+        _awaiter = nullptr;
+
+        return true;
+    }
+#endif
 }
@@ -1,12 +1,37 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <linux/pps.h>
+#if __cplusplus >= 202002L
+#include <atomic>
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#endif
 
 namespace PPS
 {
+    // a new edge as delivered by the non-blocking and the coroutine API
+    struct Edge {
+        enum class Status {
+            Ok,
+            Cancelled,
+            Error
+        };
+
+        Status status;
+        int32_t err;                // errno for Status::Error
+        struct pps_fdata data;
+    };
+
     class Device {
     public:
+#if __cplusplus >= 202002L
+        class EdgeAwaiter;
+#endif
+
         //--- public constructors ---
         Device(const std::string &devname = "/dev/pps0") noexcept(false);
         Device(const Device &rhs) = delete;
@@ -21,21 +46,98 @@ namespace PPS
         bool valid() const noexcept;
         std::string error() noexcept(false);
         std::string deviceName() const noexcept;
+        int32_t fd() const noexcept;
 
         bool parameters(struct pps_kparams &params) noexcept;
         bool setParameters(const struct pps_kparams &params) noexcept;
         bool caps(int32_t &mode) noexcept;
         bool fetch(struct pps_fdata &fdata, const struct timespec &timeout) noexcept;
+        bool tryFetch(struct pps_fdata &fdata, bool &fresh) noexcept;
+
+#if __cplusplus >= 202002L
+        // co_await dev.nextEdge() suspends until a DeviceSet driving this device sees a new edge
+        // or the stop token is triggered, only one coroutine can wait on a device at a time; a
+        // stop request resumes the coroutine on the requesting thread, a waiting coroutine has
+        // to be completed (stop token or cancel()) before the device is destroyed
+        EdgeAwaiter nextEdge(std::stop_token token = {}) noexcept;
+        bool dispatch() noexcept;
+        void cancel() noexcept;
+#endif
 
     protected:
         //--- protected methods ---
         bool open() noexcept;
         bool close() noexcept;
 
+#if __cplusplus >= 202002L
+    private:
+        //--- private methods ---
+        EdgeAwaiter *pending() noexcept;
+        void attach(EdgeAwaiter *awaiter) noexcept;
+        bool release(EdgeAwaiter *awaiter) noexcept;
+#endif
+
     private:
         //--- private properties ---
         std::string _devname;
         int32_t _fd;    // non-negative = okay, -1 = not okay
         int32_t _err;   // 0 = not set/unused, positive number = errno set
+        uint32_t _assertSequence;   // sequence numbers of the last tryFetch()
+        uint32_t _clearSequence;
+        bool _sequenceValid;
+#if __cplusplus >= 202002L
+        std::mutex _awaiterLock;    // the stop callback may complete the awaiter from any thread
+        EdgeAwaiter *_awaiter;
+#endif
+    };
+
+#if __cplusplus >= 202002L
+    class Device::EdgeAwaiter {
+    public:
+        //--- public constructors ---
+        EdgeAwaiter(Device &device, std::stop_token token) noexcept;
+
+        //--- public methods ---
+        bool await_ready() noexcept;
+        bool await_suspend(std::coroutine_handle<> handle) noexcept;
+        Edge await_resume() noexcept;
+
+    private:
+        friend class Device;
+
+        enum class State {
+            Waiting,
+            Suspended,
+            Completed
+        };
+
+        struct StopRequest {
+            EdgeAwaiter *awaiter;
+
+            void operator()() noexcept;
+        };
+
+        //--- private methods ---
+        void complete(const Edge::Status status, const int32_t err) noexcept;
+
+        //--- private properties ---
+        Device &_device;
+        std::stop_token _token;
+        std::coroutine_handle<> _handle;
+        Edge _edge;
+        std::atomic<State> _state;  // whoever sees Suspended on completion resumes the coroutine
+        std::optional<std::stop_callback<StopRequest>> _stopCallback;
+    };
+
+    // a fire and forget coroutine type, enough to run nextEdge() loops without a framework
+    struct DetachedTask {
+        struct promise_type {
+            DetachedTask get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept {}
+        };
     };
+#endif
 }
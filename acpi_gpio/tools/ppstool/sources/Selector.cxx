@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cmath>
+#include <time.h>
+#include "Selector.hxx"
+
+namespace PPS
+{
+    // weight of a new sample in the running averages
+    static const double Alpha = 0.125;
+
+    // established sources come first, then the lower score
+    static bool better(const Selector::Source &lhs, const Selector::Source &rhs) noexcept
+    {
+        const bool lhs_established = lhs.edges >= Selector::MinEdges;
+        const bool rhs_established = rhs.edges >= Selector::MinEdges;
+
+        if (lhs_established != rhs_established)
+            return lhs_established;
+
+        return lhs.score < rhs.score;
+    }
+
+    static int64_t monotonic() noexcept
+    {
+        struct timespec ts;
+
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    //--- public constructors ---
+
+    Selector::Selector() noexcept
+    : _sources(), _selected(nullptr), _second(0), _opened(0), _decided(0)
+    {
+    }
+
+    Selector::~Selector() noexcept
+    {
+    }
+
+    //--- public methods ---
+
+    bool Selector::add(Device &device) noexcept
+    {
+        for (auto &source : _sources)
+        {
+            if (source.device == &device)
+                return false;
+        }
+
+        try
+        {
+            Source source = {};
+
+            source.device = &device;
+            _sources.push_back(source);
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        _selected = nullptr;
+
+        return true;
+    }
+
+    // accounts a new edge, the interval to the previous one feeds jitter and gap rate
+    void Selector::edge(Device &device, const struct pps_fdata &data) noexcept
+    {
+        const int64_t assert_ns = static_cast<int64_t>(data.info.assert_tu.sec) * 1000000000
+                                  + data.info.assert_tu.nsec;
+        const int64_t second = (assert_ns + 500000000) / 1000000000;
+        auto it = std::find_if(_sources.begin(), _sources.end(),
+                               [&device](const Source &source) { return source.device == &device; });
+
+        if (it == _sources.end())
+            return;
+
+        Source &source = *it;
+
+        if (source.edges)
+        {
+            const int64_t interval = assert_ns - source.last_ns;
+            const int64_t periods = std::max<int64_t>((interval + 500000000) / 1000000000, 1);
+
+            for (int64_t i = 1; i < periods; ++i)
+                source.gap_rate += Alpha * (1.0 - source.gap_rate);
+            source.gap_rate -= Alpha * source.gap_rate;
+            source.missed += periods - 1;
+
+            source.jitter_ns += Alpha * (std::fabs(static_cast<double>(interval - periods
+                                                                       * 1000000000))
+                                         - source.jitter_ns);
+        }
+
+        ++source.edges;
+        source.last_ns = assert_ns;
+
+        // a late edge of an already decided second only counts for the statistics, reopening
+        // the second would decide it twice
+        if (second <= _decided)
+            return;
+
+        // an edge for a later second closes the current one without a decision, that only
+        // happens when decide() was not called in time
+        if (_second && (second > _second))
+        {
+            for (auto &other : _sources)
+                other.pending = false;
+            _second = 0;
+        }
+
+        if (!_second)
+        {
+            _second = second;
+            _opened = monotonic();
+        }
+
+        if (second == _second)
+        {
+            source.pending = true;
+            source.phase_ns = assert_ns - second * 1000000000;
+            source.data = data;
+        }
+    }
+
+    // picks the edge for the current second once all sources reported or the grace time ran
+    // out, a source without an edge for this second cannot be selected
+    bool Selector::decide(Decision &decision) noexcept
+    {
+        Source *best = nullptr;
+        bool complete = true;
+
+        if (!_second)
+            return false;
+
+        for (auto &source : _sources)
+        {
+            if (!source.pending && (source.edges >= MinEdges))
+                complete = false;
+        }
+
+        if (!complete && (monotonic() - _opened < Grace_ns))
+            return false;
+
+        agreement();
+
+        for (auto &source : _sources)
+        {
+            source.score = source.jitter_ns + source.disagreement_ns
+                           + source.gap_rate * GapPenalty_ns;
+
+            if (source.pending && (!best || better(source, *best)))
+                best = &source;
+        }
+
+        if (!best)
+            return false;
+
+        // hysteresis, the current source stays as long as it delivered and is not clearly
+        // worse than the best one
+        if (_selected && _selected->pending
+            && ((_selected->edges >= MinEdges) || (best->edges < MinEdges))
+            && (_selected->score <= best->score * 1.25 + 100.0))
+            best = _selected;
+
+        decision.previous = _selected ? _selected->device : nullptr;
+        decision.device = best->device;
+        decision.data = best->data;
+        decision.score = best->score;
+        _selected = best;
+
+        for (auto &source : _sources)
+            source.pending = false;
+        _decided = _second;
+        _second = 0;
+
+        return true;
+    }
+
+    // how long decide() may still wait for the current second, -1 = nothing pending
+    int64_t Selector::remaining_ms() const noexcept
+    {
+        if (!_second)
+            return -1;
+
+        return std::max<int64_t>((Grace_ns - (monotonic() - _opened)) / 1000000, 0);
+    }
+
+    const std::vector<Selector::Source> &Selector::sources() const noexcept
+    {
+        return _sources;
+    }
+
+    Device *Selector::selected() const noexcept
+    {
+        return _selected ? _selected->device : nullptr;
+    }
+
+    //--- protected methods ---
+
+    // distance of every pending edge to the median phase, sources missing this second keep
+    // their previous value
+    void Selector::agreement() noexcept
+    {
+        int64_t phases[64];
+        size_t count = 0;
+
+        for (auto &source : _sources)
+        {
+            if (source.pending && (count < sizeof(phases) / sizeof(phases[0])))
+                phases[count++] = source.phase_ns;
+        }
+
+        if (count < 2)
+            return;
+
+        std::sort(phases, phases + count);
+
+        const int64_t median = (count & 1) ? phases[count / 2]
+                                           : (phases[count / 2 - 1] + phases[count / 2]) / 2;
+
+        for (auto &source : _sources)
+        {
+            if (source.pending)
+                source.disagreement_ns += Alpha * (std::fabs(static_cast<double>(source.phase_ns
+                                                                                 - median))
+                                                   - source.disagreement_ns);
+        }
+    }
+}
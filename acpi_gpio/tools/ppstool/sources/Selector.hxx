@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <linux/pps.h>
+#include "PPS.hxx"
+
+namespace PPS
+{
+    // scores several PPS sources by interval jitter, missed edges and agreement with the other
+    // sources and picks one edge per second, so a failing source is dropped within the pulse
+    // it missed
+    class Selector {
+    public:
+        static const int64_t Grace_ns = 20000000;   // how long to wait for the other sources
+        static const int64_t GapPenalty_ns = 1000000;   // score of a source missing every edge
+        static const uint32_t MinEdges = 3;             // before a source can take over
+
+        struct Source {
+            Device *device;
+            uint64_t edges;
+            uint64_t missed;
+            int64_t last_ns;        // last assert timestamp
+            double jitter_ns;       // mean deviation of the interval from n seconds
+            double gap_rate;        // share of missed edges
+            double disagreement_ns; // mean distance to the median phase of all sources
+            double score;           // lower is better
+            bool pending;           // has an edge for the second being decided
+            int64_t phase_ns;       // offset of the pending edge from the full second
+            struct pps_fdata data;
+        };
+
+        struct Decision {
+            Device *device;
+            struct pps_fdata data;
+            double score;
+            Device *previous;       // differs from device when the selection switched
+        };
+
+        //--- public constructors ---
+        Selector() noexcept;
+        Selector(const Selector &rhs) = delete;
+        Selector(Selector &&rhs) = delete;
+        virtual ~Selector() noexcept;
+
+        //--- public operators ---
+        Selector &operator=(const Selector &rhs) = delete;
+        Selector &operator=(Selector &&rhs) = delete;
+
+        //--- public methods ---
+        bool add(Device &device) noexcept;
+        void edge(Device &device, const struct pps_fdata &data) noexcept;
+        bool decide(Decision &decision) noexcept;
+        int64_t remaining_ms() const noexcept;
+        const std::vector<Source> &sources() const noexcept;
+        Device *selected() const noexcept;
+
+    protected:
+        //--- protected methods ---
+        void agreement() noexcept;
+
+    private:
+        //--- private properties ---
+        std::vector<Source> _sources;
+        Source *_selected;
+        int64_t _second;        // second being decided, 0 = none
+        int64_t _opened;        // CLOCK_MONOTONIC of the first edge for _second
+        int64_t _decided;       // last second decide() picked an edge for, 0 = none
+    };
+}
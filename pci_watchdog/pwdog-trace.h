@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * pwdog - trace events
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM pwdog
+
+#if !defined(_PWDOG_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _PWDOG_TRACE_H
+
+#include <linux/tracepoint.h>
+
+DECLARE_EVENT_CLASS(pwdog_wdt,
+
+	TP_PROTO(int id, unsigned int timeout),
+
+	TP_ARGS(id, timeout),
+
+	TP_STRUCT__entry(
+		__field(int, id)
+		__field(unsigned int, timeout)
+	),
+
+	TP_fast_assign(
+		__entry->id = id;
+		__entry->timeout = timeout;
+	),
+
+	TP_printk("watchdog%d timeout=%u", __entry->id, __entry->timeout)
+);
+
+DEFINE_EVENT(pwdog_wdt, pwdog_start,
+	TP_PROTO(int id, unsigned int timeout),
+	TP_ARGS(id, timeout)
+);
+
+DEFINE_EVENT(pwdog_wdt, pwdog_stop,
+	TP_PROTO(int id, unsigned int timeout),
+	TP_ARGS(id, timeout)
+);
+
+/* a ping through the watchdog core, with the interval and margin of the keepalive stats */
+TRACE_EVENT(pwdog_ping,
+
+	TP_PROTO(int id, unsigned int timeout, u64 interval_us, u64 margin_us),
+
+	TP_ARGS(id, timeout, interval_us, margin_us),
+
+	TP_STRUCT__entry(
+		__field(int, id)
+		__field(unsigned int, timeout)
+		__field(u64, interval_us)
+		__field(u64, margin_us)
+	),
+
+	TP_fast_assign(
+		__entry->id = id;
+		__entry->timeout = timeout;
+		__entry->interval_us = interval_us;
+		__entry->margin_us = margin_us;
+	),
+
+	TP_printk("watchdog%d timeout=%u interval_us=%llu margin_us=%llu", __entry->id,
+		  __entry->timeout, __entry->interval_us, __entry->margin_us)
+);
+
+TRACE_EVENT(pwdog_irq,
+
+	TP_PROTO(int irq, bool msi, u8 intr_flag, bool handled),
+
+	TP_ARGS(irq, msi, intr_flag, handled),
+
+	TP_STRUCT__entry(
+		__field(int, irq)
+		__field(bool, msi)
+		__field(u8, intr_flag)
+		__field(bool, handled)
+	),
+
+	TP_fast_assign(
+		__entry->irq = irq;
+		__entry->msi = msi;
+		__entry->intr_flag = intr_flag;
+		__entry->handled = handled;
+	),
+
+	TP_printk("irq=%d mode=%s intr_flag=0x%02x handled=%d", __entry->irq,
+		  __entry->msi ? "MSI" : "INTx", __entry->intr_flag, __entry->handled)
+);
+
+#endif /* _PWDOG_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE pwdog-trace
+#include <trace/define_trace.h>
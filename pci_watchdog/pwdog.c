@@ -4,15 +4,31 @@
  * Copyright (C) 2021 Wilken Gottwalt
  */
 
+#include <linux/atomic.h>
+#include <linux/debugfs.h>
+#include <linux/hrtimer.h>
 #include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
 #include <linux/module.h>
 #include <linux/pci.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/u64_stats_sync.h>
 #include <linux/watchdog.h>
+#include <linux/workqueue.h>
+
+#define CREATE_TRACE_POINTS
+#include "pwdog-trace.h"
 
 #define DRIVER_NAME	"pwdog"
 
 #define HEARTBEAT	4
 #define NOWAYOUT	0
+#define KEEPALIVE	0
+#define KEEPALIVE_SLACK	10
+#define ALIVE_TIMEOUT	0
+#define PRETIMEOUT	1
 
 #define PCI_BAR		0
 #define PCI_BAR_SIZE	256
@@ -22,6 +38,9 @@
 #define INTR_RESET	0x08
 #define INTR_FLAG	0xF9 /* was an interrupt issued by this device? */
 
+#define NEAR_MISS	10 /* percent of the timeout left */
+#define STATS_BUCKETS	40 /* log2 microseconds, covers the maximum timeout */
+
 static int heartbeat = HEARTBEAT;
 module_param(heartbeat, int, 0);
 MODULE_PARM_DESC(heartbeat, "watchdog heartbeat in seconds (default="
@@ -32,22 +51,331 @@ module_param(nowayout, bool, 0);
 MODULE_PARM_DESC(nowayout, "watchdog cannot be stopped once started (default="
 		 __MODULE_STRING(NOWAYOUT) ")");
 
+static unsigned int keepalive = KEEPALIVE;
+module_param(keepalive, uint, 0);
+MODULE_PARM_DESC(keepalive, "kernel keepalive interval in percent of the heartbeat, 0 disables "
+		 "it (default=" __MODULE_STRING(KEEPALIVE) ")");
+
+static unsigned int keepalive_slack = KEEPALIVE_SLACK;
+module_param(keepalive_slack, uint, 0);
+MODULE_PARM_DESC(keepalive_slack, "kernel keepalive timer slack in percent of its interval "
+		 "(default=" __MODULE_STRING(KEEPALIVE_SLACK) ")");
+
+static unsigned int alive_timeout = ALIVE_TIMEOUT;
+module_param(alive_timeout, uint, 0);
+MODULE_PARM_DESC(alive_timeout, "seconds after the last write to the alive attribute until the "
+		 "kernel keepalive stops, 0 disables the check (default="
+		 __MODULE_STRING(ALIVE_TIMEOUT) ")");
+
+static unsigned int pretimeout = PRETIMEOUT;
+module_param(pretimeout, uint, 0);
+MODULE_PARM_DESC(pretimeout, "seconds the card raises its interrupt before the reset, fixed by "
+		 "the hardware (default=" __MODULE_STRING(PRETIMEOUT) ")");
+
+/*
+ * The watchdog core serializes all ops of a watchdog device, so the ping path is the only writer
+ * and needs no lock. syncp lets readers retry instead of seeing torn u64 values on 32 bit.
+ */
+struct pwdog_stats {
+	struct u64_stats_sync syncp;
+	ktime_t last;
+	u64 pings;
+	u64 near_misses;
+	u64 interval_min;
+	u64 interval_max;
+	u64 margin_min;
+	u64 margin_max;
+	u64 interval_hist[STATS_BUCKETS];
+	u64 margin_hist[STATS_BUCKETS];
+};
+
+struct pwdog_data;
+
+/* all register access goes through these, so the card can be replaced by an emulation */
+struct pwdog_reg_ops {
+	u8 (*read8)(struct pwdog_data *priv, unsigned int reg);
+	void (*write8)(struct pwdog_data *priv, unsigned int reg, u8 value);
+};
+
 struct pwdog_data {
 	struct pci_dev *pdev;
 	void __iomem *base_addr;
+	const struct pwdog_reg_ops *reg_ops;
 	struct watchdog_device wdd;
+	int irq;
+	bool msi;
+	struct pwdog_stats stats;
+	struct dentry *debugfs;
+	unsigned int keepalive;		/* effective keepalive parameter of this card */
+	struct hrtimer keepalive_timer;
+	struct work_struct health_work;
+	atomic64_t alive_ns;
+	atomic64_t keepalive_pings;
+	atomic64_t keepalive_skips;
+	void (*notify_pretimeout)(struct watchdog_device *wdd);
 };
 
 static struct watchdog_info pwdog_wdt_info = {
 	.identity = "PWDOG timer",
-	.options = WDIOF_KEEPALIVEPING | WDIOF_MAGICCLOSE,
+	.options = WDIOF_KEEPALIVEPING | WDIOF_MAGICCLOSE | WDIOF_PRETIMEOUT,
+};
+
+/*----- register access -----*/
+
+static u8 pwdog_mmio_read8(struct pwdog_data *priv, unsigned int reg)
+{
+	return ioread8(priv->base_addr + reg);
+}
+
+static void pwdog_mmio_write8(struct pwdog_data *priv, unsigned int reg, u8 value)
+{
+	iowrite8(value, priv->base_addr + reg);
+}
+
+static const struct pwdog_reg_ops pwdog_mmio_ops = {
+	.read8	= pwdog_mmio_read8,
+	.write8	= pwdog_mmio_write8,
+};
+
+static inline u8 pwdog_read8(struct pwdog_data *priv, unsigned int reg)
+{
+	return priv->reg_ops->read8(priv, reg);
+}
+
+static inline void pwdog_write8(struct pwdog_data *priv, unsigned int reg, u8 value)
+{
+	priv->reg_ops->write8(priv, reg, value);
+}
+
+/*----- keepalive statistics -----*/
+
+static void pwdog_stats_reset(struct pwdog_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	u64_stats_init(&stats->syncp);
+	stats->interval_min = U64_MAX;
+	stats->margin_min = U64_MAX;
+}
+
+static void pwdog_stats_add(u64 *hist, u64 *min, u64 *max, u64 us)
+{
+	unsigned int bucket = min_t(unsigned int, ilog2(us | 1), STATS_BUCKETS - 1);
+
+	++hist[bucket];
+	if (us < *min)
+		*min = us;
+	if (us > *max)
+		*max = us;
+}
+
+static void pwdog_stats_ping(struct pwdog_data *priv)
+{
+	struct pwdog_stats *stats = &priv->stats;
+	ktime_t now = ktime_get();
+	u64 timeout_us = (u64)priv->wdd.timeout * USEC_PER_SEC;
+	u64 interval_us, margin_us;
+	unsigned long flags;
+
+	/* the first ping after a start measures against the start */
+	interval_us = ktime_us_delta(now, stats->last);
+	margin_us = interval_us < timeout_us ? timeout_us - interval_us : 0;
+	stats->last = now;
+
+	flags = u64_stats_update_begin_irqsave(&stats->syncp);
+	pwdog_stats_add(stats->interval_hist, &stats->interval_min, &stats->interval_max,
+			interval_us);
+	pwdog_stats_add(stats->margin_hist, &stats->margin_min, &stats->margin_max, margin_us);
+	if (margin_us * 100 < timeout_us * NEAR_MISS)
+		++stats->near_misses;
+	++stats->pings;
+	u64_stats_update_end_irqrestore(&stats->syncp, flags);
+
+	trace_pwdog_ping(priv->wdd.id, priv->wdd.timeout, interval_us, margin_us);
+}
+
+static void pwdog_stats_hist_show(struct seq_file *s, const char *name, const u64 *hist)
+{
+	unsigned int i;
+
+	seq_printf(s, "%s histogram:\n", name);
+	for (i = 0; i < STATS_BUCKETS; ++i)
+		if (hist[i])
+			seq_printf(s, "  >= %llu us: %llu\n", i ? 1ULL << i : 0, hist[i]);
+}
+
+static int pwdog_stats_show(struct seq_file *s, void *unused)
+{
+	struct pwdog_data *priv = s->private;
+	struct pwdog_stats *stats;
+	unsigned int start;
+
+	stats = kmalloc(sizeof(*stats), GFP_KERNEL);
+	if (!stats)
+		return -ENOMEM;
+
+	do {
+		start = u64_stats_fetch_begin(&priv->stats.syncp);
+		memcpy(stats, &priv->stats, sizeof(*stats));
+	} while (u64_stats_fetch_retry(&priv->stats.syncp, start));
+
+	seq_printf(s, "timeout_us: %llu\n", (u64)READ_ONCE(priv->wdd.timeout) * USEC_PER_SEC);
+	seq_printf(s, "pings: %llu\n", stats->pings);
+	seq_printf(s, "near_misses: %llu\n", stats->near_misses);
+	if (priv->keepalive)
+		seq_printf(s, "kernel_keepalive: pings %lld skips %lld\n",
+			   atomic64_read(&priv->keepalive_pings),
+			   atomic64_read(&priv->keepalive_skips));
+	if (stats->pings) {
+		seq_printf(s, "interval_us: min %llu max %llu\n", stats->interval_min,
+			   stats->interval_max);
+		seq_printf(s, "margin_us: min %llu max %llu\n", stats->margin_min,
+			   stats->margin_max);
+		pwdog_stats_hist_show(s, "interval", stats->interval_hist);
+		pwdog_stats_hist_show(s, "margin", stats->margin_hist);
+	}
+
+	kfree(stats);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(pwdog_stats);
+
+/*----- kernel keepalive -----*/
+
+static inline void pwdog_trigger(struct pwdog_data *priv)
+{
+	pwdog_write8(priv, WDT_TRIGGER, 0);
+}
+
+/* does nothing, it only has to get scheduled to show that the system still makes progress */
+static void pwdog_health_work(struct work_struct *work)
+{
+}
+
+static bool pwdog_healthy(struct pwdog_data *priv)
+{
+	/* the work queued on the last tick must have run in between */
+	if (work_pending(&priv->health_work))
+		return false;
+
+	if (alive_timeout && ktime_get_ns() - atomic64_read(&priv->alive_ns) >
+	    (u64)alive_timeout * NSEC_PER_SEC)
+		return false;
+
+	return true;
+}
+
+static void pwdog_keepalive_interval(struct pwdog_data *priv, u64 *interval_ns, u64 *slack_ns)
+{
+	*interval_ns = div_u64((u64)READ_ONCE(priv->wdd.timeout) * NSEC_PER_SEC * priv->keepalive,
+			       100);
+	*slack_ns = div_u64(*interval_ns * keepalive_slack, 100);
+}
+
+/* pings the card directly, the keepalive statistics only account for the userspace pings */
+static enum hrtimer_restart pwdog_keepalive(struct hrtimer *timer)
+{
+	struct pwdog_data *priv = container_of(timer, struct pwdog_data, keepalive_timer);
+	u64 interval_ns, slack_ns;
+
+	if (pwdog_healthy(priv)) {
+		pwdog_trigger(priv);
+		atomic64_inc(&priv->keepalive_pings);
+	} else {
+		atomic64_inc(&priv->keepalive_skips);
+	}
+	queue_work(system_wq, &priv->health_work);
+
+	pwdog_keepalive_interval(priv, &interval_ns, &slack_ns);
+	hrtimer_set_expires_range_ns(timer, ktime_add_ns(ktime_get(), interval_ns), slack_ns);
+
+	return HRTIMER_RESTART;
+}
+
+static void pwdog_keepalive_arm(struct pwdog_data *priv)
+{
+	u64 interval_ns, slack_ns;
+
+	pwdog_keepalive_interval(priv, &interval_ns, &slack_ns);
+	hrtimer_start_range_ns(&priv->keepalive_timer, ns_to_ktime(interval_ns), slack_ns,
+			       HRTIMER_MODE_REL);
+}
+
+static void pwdog_keepalive_start(struct pwdog_data *priv)
+{
+	if (!priv->keepalive)
+		return;
+
+	/* userspace gets a full alive_timeout after every start */
+	atomic64_set(&priv->alive_ns, ktime_get_ns());
+	pwdog_keepalive_arm(priv);
+}
+
+static void pwdog_keepalive_stop(struct pwdog_data *priv)
+{
+	if (!priv->keepalive)
+		return;
+
+	hrtimer_cancel(&priv->keepalive_timer);
+	cancel_work_sync(&priv->health_work);
+}
+
+static ssize_t alive_store(struct device *dev, struct device_attribute *attr, const char *buf,
+			   size_t count)
+{
+	struct watchdog_device *wdd = dev_get_drvdata(dev);
+	struct pwdog_data *priv = watchdog_get_drvdata(wdd);
+
+	atomic64_set(&priv->alive_ns, ktime_get_ns());
+
+	return count;
+}
+
+static struct device_attribute pwdog_alive_attr = {
+	.attr = {
+		.name = "alive",
+		.mode = 0200,
+	},
+	.store = alive_store,
+};
+
+static struct attribute *pwdog_attrs[] = {
+	&pwdog_alive_attr.attr,
+	NULL,
 };
 
+/* alive only means something while the kernel keepalive checks it */
+static umode_t pwdog_attr_is_visible(struct kobject *kobj, struct attribute *attr, int n)
+{
+	struct watchdog_device *wdd = dev_get_drvdata(kobj_to_dev(kobj));
+	struct pwdog_data *priv = watchdog_get_drvdata(wdd);
+
+	if (attr == &pwdog_alive_attr.attr && (!priv->keepalive || !alive_timeout))
+		return 0;
+
+	return attr->mode;
+}
+
+static const struct attribute_group pwdog_group = {
+	.attrs		= pwdog_attrs,
+	.is_visible	= pwdog_attr_is_visible,
+};
+
+static const struct attribute_group *pwdog_groups[] = {
+	&pwdog_group,
+	NULL,
+};
+
+/*----- watchdog ops -----*/
+
 static int pwdog_wdt_timer_start(struct watchdog_device *wdd)
 {
 	struct pwdog_data *priv = watchdog_get_drvdata(wdd);
 
-	iowrite8(0, priv->base_addr + WDT_TRIGGER);
+	pwdog_trigger(priv);
+	priv->stats.last = ktime_get();
+	pwdog_keepalive_start(priv);
+	trace_pwdog_start(wdd->id, wdd->timeout);
 
 	return 0;
 }
@@ -56,7 +384,10 @@ static int pwdog_wdt_timer_stop(struct watchdog_device *wdd)
 {
 	struct pwdog_data *priv = watchdog_get_drvdata(wdd);
 
-	iowrite8(0, priv->base_addr + WDT_DISABLE);
+	/* the timer must not retrigger the card after it got disabled */
+	pwdog_keepalive_stop(priv);
+	pwdog_write8(priv, WDT_DISABLE, 0);
+	trace_pwdog_stop(wdd->id, wdd->timeout);
 
 	return 0;
 }
@@ -65,37 +396,147 @@ static int pwdog_wdt_timer_ping(struct watchdog_device *wdd)
 {
 	struct pwdog_data *priv = watchdog_get_drvdata(wdd);
 
-	iowrite8(0, priv->base_addr + WDT_TRIGGER);
+	pwdog_trigger(priv);
+	pwdog_stats_ping(priv);
+
+	return 0;
+}
+
+static int pwdog_wdt_set_timeout(struct watchdog_device *wdd, unsigned int timeout)
+{
+	struct pwdog_data *priv = watchdog_get_drvdata(wdd);
+
+	WRITE_ONCE(wdd->timeout, timeout);
+
+	/* the core only drops a pretimeout that no longer fits if there is no set_timeout op */
+	if (wdd->pretimeout >= timeout)
+		wdd->pretimeout = 0;
+
+	/* a running kernel keepalive has to follow a shorter timeout right away */
+	if (priv->keepalive && watchdog_active(wdd)) {
+		hrtimer_cancel(&priv->keepalive_timer);
+		pwdog_keepalive_arm(priv);
+	}
+
+	return 0;
+}
+
+/* the warning time is fixed by the card, it can only be turned off or left as it is */
+static int pwdog_wdt_set_pretimeout(struct watchdog_device *wdd, unsigned int timeout)
+{
+	if (timeout && timeout != pretimeout)
+		return -EINVAL;
+
+	wdd->pretimeout = timeout;
 
 	return 0;
 }
 
 static const struct watchdog_ops pwdog_wdt_ops = {
-	.owner	= THIS_MODULE,
-	.start	= pwdog_wdt_timer_start,
-	.stop	= pwdog_wdt_timer_stop,
-	.ping	= pwdog_wdt_timer_ping,
+	.owner		= THIS_MODULE,
+	.start		= pwdog_wdt_timer_start,
+	.stop		= pwdog_wdt_timer_stop,
+	.ping		= pwdog_wdt_timer_ping,
+	.set_timeout	= pwdog_wdt_set_timeout,
+	.set_pretimeout	= pwdog_wdt_set_pretimeout,
 };
 
+/*----- interrupt handling -----*/
+
+static void pwdog_irq_ack(struct pwdog_data *priv)
+{
+	pwdog_write8(priv, INTR_RESET, pwdog_read8(priv, INTR_RESET));
+	pwdog_write8(priv, INTR_FLAG, 0);
+
+	/* the card warns before it resets the machine, let the pretimeout governor handle it */
+	if (watchdog_active(&priv->wdd) && priv->wdd.pretimeout)
+		priv->notify_pretimeout(&priv->wdd);
+}
+
 static irqreturn_t irq_handler(int irq, void *dev_id)
 {
 	struct pwdog_data *priv = dev_id;
 	u8 intr_flag;
 
-	intr_flag = ioread8(priv->base_addr + INTR_FLAG);
+	intr_flag = pwdog_read8(priv, INTR_FLAG);
+	trace_pwdog_irq(irq, false, intr_flag, intr_flag != 0);
 	if (intr_flag == 0)
 		return IRQ_NONE;
 
-	iowrite8(ioread8(priv->base_addr + INTR_RESET), priv->base_addr + INTR_RESET);
-	iowrite8(0, priv->base_addr + INTR_FLAG);
+	pwdog_irq_ack(priv);
 
 	return IRQ_HANDLED;
 }
 
+/* an MSI vector belongs to this card alone, no need to ask it whether it raised the IRQ */
+static irqreturn_t msi_irq_handler(int irq, void *dev_id)
+{
+	struct pwdog_data *priv = dev_id;
+
+	trace_pwdog_irq(irq, true, 0, true);
+	pwdog_irq_ack(priv);
+
+	return IRQ_HANDLED;
+}
+
+static void pwdog_free_irq_vectors(void *data)
+{
+	pci_free_irq_vectors(data);
+}
+
+static int pwdog_request_irq(struct pwdog_data *priv, struct pci_dev *pdev)
+{
+	int err;
+
+	/* MSI first, the shared legacy INTx line is only the fallback */
+	pci_set_master(pdev);
+	err = pci_alloc_irq_vectors(pdev, 1, 1, PCI_IRQ_MSI | PCI_IRQ_LEGACY);
+	if (err < 0) {
+		dev_err(&pdev->dev, "failed to allocate IRQ vector (%d)\n", err);
+		return err;
+	}
+
+	/* added before the IRQ is requested, so devm frees the IRQ first */
+	err = devm_add_action_or_reset(&pdev->dev, pwdog_free_irq_vectors, pdev);
+	if (err < 0)
+		return err;
+
+	priv->irq = pci_irq_vector(pdev, 0);
+	priv->msi = pdev->msi_enabled;
+
+	if (priv->msi)
+		err = devm_request_irq(&pdev->dev, priv->irq, msi_irq_handler, 0, DRIVER_NAME,
+				       priv);
+	else
+		err = devm_request_irq(&pdev->dev, priv->irq, irq_handler, IRQF_SHARED,
+				       DRIVER_NAME, priv);
+	if (err < 0)
+		dev_err(&pdev->dev, "failed to acquire IRQ (%d)\n", err);
+
+	return err;
+}
+
+/*----- pci driver -----*/
+
+/* everything but the PCI resources, shared with the KUnit suite */
+static void pwdog_data_init(struct pwdog_data *priv, const struct pwdog_reg_ops *reg_ops)
+{
+	priv->reg_ops = reg_ops;
+	pwdog_stats_reset(&priv->stats);
+	hrtimer_init(&priv->keepalive_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	priv->keepalive_timer.function = pwdog_keepalive;
+	INIT_WORK(&priv->health_work, pwdog_health_work);
+	priv->keepalive = keepalive;
+	priv->notify_pretimeout = watchdog_notify_pretimeout;
+}
+
 static void pwdog_disable(void *data)
 {
 	struct pwdog_data *priv = data;
 
+	debugfs_remove_recursive(priv->debugfs);
+	pwdog_keepalive_stop(priv);
+
 	dev_info(&priv->pdev->dev, "release resources\n");
 }
 
@@ -103,21 +544,29 @@ static int pwdog_probe(struct pci_dev *pdev, const struct pci_device_id *ent)
 {
 	struct pwdog_data *priv;
 	struct watchdog_device *wdd;
+	char name[32];
 	int err;
 
 	priv = devm_kzalloc(&pdev->dev, sizeof(*priv), GFP_KERNEL);
 	if (!priv)
 		return -ENOMEM;
+	priv->pdev = pdev;
+	pwdog_data_init(priv, &pwdog_mmio_ops);
+	if (priv->keepalive >= 100) {
+		dev_warn(&pdev->dev, "keepalive of %u%% is beyond the heartbeat, disabled\n",
+			 priv->keepalive);
+		priv->keepalive = 0;
+	}
 
-	err = pci_enable_device(pdev);
+	/* managed, so the device is only disabled after devm released the IRQ and its vectors */
+	err = pcim_enable_device(pdev);
 	if (err < 0)
 		return err;
 
 	if (pci_set_dma_mask(pdev, DMA_BIT_MASK(64)) < 0) {
 		if ((pci_set_dma_mask(pdev, DMA_BIT_MASK(32))) < 0) {
 			dev_err(&pdev->dev, "no usable DMA configuration\n");
-			err = -EFAULT;
-			goto fail;
+			return -EFAULT;
 		} else {
 			pci_set_consistent_dma_mask(pdev, DMA_BIT_MASK(32));
 		}
@@ -125,27 +574,28 @@ static int pwdog_probe(struct pci_dev *pdev, const struct pci_device_id *ent)
 		pci_set_consistent_dma_mask(pdev, DMA_BIT_MASK(64));
 	}
 
-	priv->base_addr = pci_iomap(pdev, PCI_BAR, PCI_BAR_SIZE);
+	priv->base_addr = pcim_iomap(pdev, PCI_BAR, PCI_BAR_SIZE);
 	if (!priv->base_addr) {
 		dev_warn(&pdev->dev, "unable to obtain io-mem address\n");
-		goto fail;
+		return -ENOMEM;
 	}
 
-	err = devm_request_irq(&pdev->dev, pdev->irq, irq_handler, IRQF_SHARED, DRIVER_NAME, priv);
-	if (err < 0) {
-		dev_err(&pdev->dev, "failed to acquire IRQ (%d)\n", err);
-		goto fail;
-	}
+	err = pwdog_request_irq(priv, pdev);
+	if (err < 0)
+		return err;
 
 	wdd = &priv->wdd;
 	wdd->parent = &pdev->dev;
 	wdd->info = &pwdog_wdt_info;
 	wdd->ops = &pwdog_wdt_ops;
+	wdd->groups = pwdog_groups;
 	wdd->timeout = HEARTBEAT;
 	wdd->min_timeout = 1;
 	wdd->max_timeout = 32400;
 
 	watchdog_init_timeout(wdd, heartbeat, NULL);
+	if (pretimeout < wdd->timeout)
+		wdd->pretimeout = pretimeout;
 	watchdog_set_nowayout(wdd, nowayout);
 	watchdog_stop_on_reboot(wdd);
 	watchdog_stop_on_unregister(wdd);
@@ -153,25 +603,24 @@ static int pwdog_probe(struct pci_dev *pdev, const struct pci_device_id *ent)
 
 	err = devm_watchdog_register_device(&pdev->dev, wdd);
 	if (err < 0)
-		goto fail;
+		return err;
 
 	err = devm_add_action_or_reset(&pdev->dev, pwdog_disable, priv);
 	if (err < 0) {
 		dev_err(&pdev->dev, "failed to add disable action\n");
-		goto fail;
+		return err;
 	}
 
-	dev_info(&pdev->dev, "registered IRQ (%d)\n", pdev->irq);
+	dev_info(&pdev->dev, "registered IRQ (%d, %s)\n", priv->irq, priv->msi ? "MSI" : "INTx");
+
+	/* debugfs is optional, errors are not worth failing the probe for */
+	snprintf(name, sizeof(name), "%s-%s", DRIVER_NAME, pci_name(pdev));
+	priv->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_file("keepalive", 0444, priv->debugfs, priv, &pwdog_stats_fops);
 
-	priv->pdev = pdev;
 	pci_set_drvdata(pdev, priv);
 
 	return 0;
-
-fail:
-	pci_disable_device(pdev);
-
-	return err;
 }
 
 static const struct pci_device_id pwdog_pci_ids[] = {
@@ -186,6 +635,10 @@ static struct pci_driver pwdog_driver = {
 };
 module_pci_driver(pwdog_driver);
 
+#ifdef PWDOG_KUNIT_TEST
+#include "pwdog_kunit.c"
+#endif
+
 MODULE_AUTHOR("Wilken Gottwalt");
 MODULE_DESCRIPTION("simple PCI driver for PCI Quancom watchdog cards");
 MODULE_LICENSE("GPL v2");
@@ -0,0 +1,335 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * pwdog_kunit - runs the pwdog ops and interrupt handlers against an emulated card
+ * Copyright (C) 2021 Wilken Gottwalt
+ *
+ * Included at the end of pwdog.c when built with "make KUNIT=1", so it sees the static functions.
+ */
+
+#include <kunit/test.h>
+
+#define PWDOG_KUNIT_LOOPS	10000U
+
+/* the register behaviour the driver relies on, everything else is plain memory */
+struct pwdog_fake_bar {
+	u8 regs[PCI_BAR_SIZE];
+	bool running;
+	bool intr_pending;
+	unsigned int triggers;
+	unsigned int disables;
+	unsigned int reads;
+	unsigned int writes;
+};
+
+struct pwdog_kunit_dev {
+	struct pwdog_data priv;
+	struct pwdog_fake_bar bar;
+	unsigned int pretimeouts;
+};
+
+static inline struct pwdog_fake_bar *pwdog_fake_bar(struct pwdog_data *priv)
+{
+	return &container_of(priv, struct pwdog_kunit_dev, priv)->bar;
+}
+
+static u8 pwdog_fake_read8(struct pwdog_data *priv, unsigned int reg)
+{
+	struct pwdog_fake_bar *bar = pwdog_fake_bar(priv);
+
+	++bar->reads;
+
+	return bar->regs[reg % PCI_BAR_SIZE];
+}
+
+static void pwdog_fake_write8(struct pwdog_data *priv, unsigned int reg, u8 value)
+{
+	struct pwdog_fake_bar *bar = pwdog_fake_bar(priv);
+
+	++bar->writes;
+
+	switch (reg) {
+	case WDT_TRIGGER:
+		bar->running = true;
+		++bar->triggers;
+		break;
+	case WDT_DISABLE:
+		bar->running = false;
+		++bar->disables;
+		break;
+	case INTR_RESET:
+		/* writing back the latched value releases the interrupt */
+		if (bar->intr_pending && value == bar->regs[INTR_RESET]) {
+			bar->intr_pending = false;
+			bar->regs[INTR_RESET] = 0;
+		}
+		break;
+	default:
+		bar->regs[reg % PCI_BAR_SIZE] = value;
+	}
+}
+
+static const struct pwdog_reg_ops pwdog_fake_ops = {
+	.read8	= pwdog_fake_read8,
+	.write8	= pwdog_fake_write8,
+};
+
+static void pwdog_fake_raise(struct pwdog_fake_bar *bar)
+{
+	bar->intr_pending = true;
+	bar->regs[INTR_RESET] = 0x01;
+	bar->regs[INTR_FLAG] = 0x01;
+}
+
+static void pwdog_fake_clear_counters(struct pwdog_fake_bar *bar)
+{
+	bar->triggers = 0;
+	bar->disables = 0;
+	bar->reads = 0;
+	bar->writes = 0;
+}
+
+/* stands in for the pretimeout governor */
+static void pwdog_fake_notify_pretimeout(struct watchdog_device *wdd)
+{
+	++container_of(wdd, struct pwdog_kunit_dev, priv.wdd)->pretimeouts;
+}
+
+/*----- test setup -----*/
+
+static int pwdog_kunit_init(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev;
+	struct watchdog_device *wdd;
+
+	kdev = kunit_kzalloc(test, sizeof(*kdev), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, kdev);
+
+	pwdog_data_init(&kdev->priv, &pwdog_fake_ops);
+	kdev->priv.keepalive = 0;
+	kdev->priv.notify_pretimeout = pwdog_fake_notify_pretimeout;
+
+	wdd = &kdev->priv.wdd;
+	wdd->info = &pwdog_wdt_info;
+	wdd->ops = &pwdog_wdt_ops;
+	wdd->timeout = HEARTBEAT;
+	wdd->min_timeout = 1;
+	wdd->max_timeout = 32400;
+	watchdog_set_drvdata(wdd, &kdev->priv);
+
+	test->priv = kdev;
+
+	return 0;
+}
+
+static void pwdog_kunit_exit(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+
+	hrtimer_cancel(&kdev->priv.keepalive_timer);
+	cancel_work_sync(&kdev->priv.health_work);
+}
+
+/*----- test cases -----*/
+
+static void pwdog_test_start(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct watchdog_device *wdd = &kdev->priv.wdd;
+
+	KUNIT_EXPECT_EQ(test, wdd->ops->start(wdd), 0);
+	KUNIT_EXPECT_TRUE(test, kdev->bar.running);
+	KUNIT_EXPECT_EQ(test, kdev->bar.triggers, 1U);
+	KUNIT_EXPECT_NE(test, ktime_to_ns(kdev->priv.stats.last), 0LL);
+	KUNIT_EXPECT_FALSE(test, hrtimer_active(&kdev->priv.keepalive_timer));
+}
+
+static void pwdog_test_stop(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct watchdog_device *wdd = &kdev->priv.wdd;
+
+	/* with the kernel keepalive running, stop has to take the timer down as well */
+	kdev->priv.keepalive = 50;
+	KUNIT_EXPECT_EQ(test, wdd->ops->start(wdd), 0);
+	KUNIT_EXPECT_TRUE(test, hrtimer_active(&kdev->priv.keepalive_timer));
+
+	KUNIT_EXPECT_EQ(test, wdd->ops->stop(wdd), 0);
+	KUNIT_EXPECT_FALSE(test, kdev->bar.running);
+	KUNIT_EXPECT_EQ(test, kdev->bar.disables, 1U);
+	KUNIT_EXPECT_FALSE(test, hrtimer_active(&kdev->priv.keepalive_timer));
+}
+
+static void pwdog_test_ping(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct watchdog_device *wdd = &kdev->priv.wdd;
+	struct pwdog_stats *stats = &kdev->priv.stats;
+	u64 late_ns = div_u64((u64)wdd->timeout * NSEC_PER_SEC * (100 - NEAR_MISS / 2), 100);
+
+	wdd->ops->start(wdd);
+	KUNIT_EXPECT_EQ(test, wdd->ops->ping(wdd), 0);
+	KUNIT_EXPECT_EQ(test, wdd->ops->ping(wdd), 0);
+	KUNIT_EXPECT_EQ(test, kdev->bar.triggers, 3U);
+	KUNIT_EXPECT_EQ(test, stats->pings, 2ULL);
+	KUNIT_EXPECT_EQ(test, stats->near_misses, 0ULL);
+
+	/* a ping with less than NEAR_MISS percent of the timeout left */
+	stats->last = ktime_sub_ns(ktime_get(), late_ns);
+	wdd->ops->ping(wdd);
+	KUNIT_EXPECT_EQ(test, stats->pings, 3ULL);
+	KUNIT_EXPECT_EQ(test, stats->near_misses, 1ULL);
+	KUNIT_EXPECT_GE(test, stats->interval_max, div_u64(late_ns, NSEC_PER_USEC));
+}
+
+static void pwdog_test_set_timeout(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct watchdog_device *wdd = &kdev->priv.wdd;
+	s64 remaining_ns;
+
+	wdd->pretimeout = 3;
+	KUNIT_EXPECT_EQ(test, wdd->ops->set_timeout(wdd, 8), 0);
+	KUNIT_EXPECT_EQ(test, wdd->timeout, 8U);
+	KUNIT_EXPECT_EQ(test, wdd->pretimeout, 3U);
+
+	/* a pretimeout that does not fit anymore is dropped */
+	KUNIT_EXPECT_EQ(test, wdd->ops->set_timeout(wdd, 2), 0);
+	KUNIT_EXPECT_EQ(test, wdd->pretimeout, 0U);
+
+	/* the running kernel keepalive follows the shorter timeout */
+	kdev->priv.keepalive = 50;
+	wdd->ops->set_timeout(wdd, 60);
+	wdd->ops->start(wdd);
+	set_bit(WDOG_ACTIVE, &wdd->status);
+	wdd->ops->set_timeout(wdd, 2);
+	remaining_ns = ktime_to_ns(hrtimer_get_remaining(&kdev->priv.keepalive_timer));
+	KUNIT_EXPECT_LE(test, remaining_ns, (s64)NSEC_PER_SEC);
+
+	wdd->ops->stop(wdd);
+	clear_bit(WDOG_ACTIVE, &wdd->status);
+}
+
+static void pwdog_test_irq_ack(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct pwdog_data *priv = &kdev->priv;
+
+	/* a shared INTx line, the card did not raise it */
+	KUNIT_EXPECT_EQ(test, irq_handler(0, priv), IRQ_NONE);
+	KUNIT_EXPECT_EQ(test, kdev->bar.writes, 0U);
+
+	pwdog_fake_raise(&kdev->bar);
+	KUNIT_EXPECT_EQ(test, irq_handler(0, priv), IRQ_HANDLED);
+	KUNIT_EXPECT_FALSE(test, kdev->bar.intr_pending);
+	KUNIT_EXPECT_EQ(test, kdev->bar.regs[INTR_FLAG], 0);
+
+	/* MSI skips the flag check, but the handshake stays the same */
+	pwdog_fake_raise(&kdev->bar);
+	KUNIT_EXPECT_EQ(test, msi_irq_handler(0, priv), IRQ_HANDLED);
+	KUNIT_EXPECT_FALSE(test, kdev->bar.intr_pending);
+	KUNIT_EXPECT_EQ(test, kdev->bar.regs[INTR_FLAG], 0);
+}
+
+static void pwdog_test_pretimeout(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct pwdog_data *priv = &kdev->priv;
+	struct watchdog_device *wdd = &priv->wdd;
+
+	/* only the warning time of the card or none at all */
+	KUNIT_EXPECT_EQ(test, wdd->ops->set_pretimeout(wdd, pretimeout + 1), -EINVAL);
+	KUNIT_EXPECT_EQ(test, wdd->ops->set_pretimeout(wdd, 0), 0);
+	KUNIT_EXPECT_EQ(test, wdd->pretimeout, 0U);
+	KUNIT_EXPECT_EQ(test, wdd->ops->set_pretimeout(wdd, pretimeout), 0);
+	KUNIT_EXPECT_EQ(test, wdd->pretimeout, pretimeout);
+
+	/* a stopped watchdog has nothing to warn about */
+	pwdog_fake_raise(&kdev->bar);
+	KUNIT_EXPECT_EQ(test, irq_handler(0, priv), IRQ_HANDLED);
+	KUNIT_EXPECT_EQ(test, kdev->pretimeouts, 0U);
+
+	wdd->ops->start(wdd);
+	set_bit(WDOG_ACTIVE, &wdd->status);
+
+	pwdog_fake_raise(&kdev->bar);
+	KUNIT_EXPECT_EQ(test, irq_handler(0, priv), IRQ_HANDLED);
+	KUNIT_EXPECT_EQ(test, kdev->pretimeouts, 1U);
+	KUNIT_EXPECT_EQ(test, kdev->bar.regs[INTR_FLAG], 0);
+	KUNIT_EXPECT_FALSE(test, kdev->bar.intr_pending);
+
+	/* the flag is gone, so the next shared IRQ is not ours and must not notify again */
+	KUNIT_EXPECT_EQ(test, irq_handler(0, priv), IRQ_NONE);
+	KUNIT_EXPECT_EQ(test, kdev->pretimeouts, 1U);
+
+	/* with the pretimeout turned off the interrupt is only acknowledged */
+	wdd->ops->set_pretimeout(wdd, 0);
+	pwdog_fake_raise(&kdev->bar);
+	KUNIT_EXPECT_EQ(test, irq_handler(0, priv), IRQ_HANDLED);
+	KUNIT_EXPECT_EQ(test, kdev->pretimeouts, 1U);
+	KUNIT_EXPECT_FALSE(test, kdev->bar.intr_pending);
+
+	wdd->ops->stop(wdd);
+	clear_bit(WDOG_ACTIVE, &wdd->status);
+}
+
+/* time per op and register accesses per op, the emulation itself costs next to nothing */
+static void pwdog_test_op_cost(struct kunit *test)
+{
+	struct pwdog_kunit_dev *kdev = test->priv;
+	struct watchdog_device *wdd = &kdev->priv.wdd;
+	struct pwdog_fake_bar *bar = &kdev->bar;
+	unsigned int i;
+	u64 start_ns;
+
+#define PWDOG_KUNIT_COST(name, op)							\
+	do {										\
+		pwdog_fake_clear_counters(bar);						\
+		start_ns = ktime_get_ns();						\
+		for (i = 0; i < PWDOG_KUNIT_LOOPS; ++i)					\
+			op;								\
+		kunit_info(test, "%-12s %6llu ns/op %u reads %u writes\n", name,	\
+			   div_u64(ktime_get_ns() - start_ns, PWDOG_KUNIT_LOOPS),	\
+			   bar->reads / PWDOG_KUNIT_LOOPS, bar->writes / PWDOG_KUNIT_LOOPS); \
+	} while (0)
+
+	PWDOG_KUNIT_COST("start", wdd->ops->start(wdd));
+	KUNIT_EXPECT_EQ(test, bar->writes, PWDOG_KUNIT_LOOPS);
+
+	PWDOG_KUNIT_COST("ping", wdd->ops->ping(wdd));
+	KUNIT_EXPECT_EQ(test, bar->writes, PWDOG_KUNIT_LOOPS);
+
+	PWDOG_KUNIT_COST("stop", wdd->ops->stop(wdd));
+	KUNIT_EXPECT_EQ(test, bar->writes, PWDOG_KUNIT_LOOPS);
+
+	PWDOG_KUNIT_COST("set_timeout", wdd->ops->set_timeout(wdd, HEARTBEAT));
+	KUNIT_EXPECT_EQ(test, bar->reads + bar->writes, 0U);
+
+	PWDOG_KUNIT_COST("irq", (pwdog_fake_raise(bar), irq_handler(0, &kdev->priv)));
+	KUNIT_EXPECT_EQ(test, bar->reads, 2 * PWDOG_KUNIT_LOOPS);
+	KUNIT_EXPECT_EQ(test, bar->writes, 2 * PWDOG_KUNIT_LOOPS);
+
+	PWDOG_KUNIT_COST("msi_irq", (pwdog_fake_raise(bar), msi_irq_handler(0, &kdev->priv)));
+	KUNIT_EXPECT_EQ(test, bar->reads, PWDOG_KUNIT_LOOPS);
+	KUNIT_EXPECT_EQ(test, bar->writes, 2 * PWDOG_KUNIT_LOOPS);
+
+#undef PWDOG_KUNIT_COST
+}
+
+static struct kunit_case pwdog_test_cases[] = {
+	KUNIT_CASE(pwdog_test_start),
+	KUNIT_CASE(pwdog_test_stop),
+	KUNIT_CASE(pwdog_test_ping),
+	KUNIT_CASE(pwdog_test_set_timeout),
+	KUNIT_CASE(pwdog_test_irq_ack),
+	KUNIT_CASE(pwdog_test_pretimeout),
+	KUNIT_CASE(pwdog_test_op_cost),
+	{ },
+};
+
+static struct kunit_suite pwdog_test_suite = {
+	.name		= DRIVER_NAME,
+	.init		= pwdog_kunit_init,
+	.exit		= pwdog_kunit_exit,
+	.test_cases	= pwdog_test_cases,
+};
+kunit_test_suite(pwdog_test_suite);
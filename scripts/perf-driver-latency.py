@@ -0,0 +1,151 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# perf-driver-latency.py - summarizes the trace events of the example drivers
+#
+# Copyright (C) 2021 Wilken Gottwalt
+#
+# usage:
+#   perf record -e 'acpi_gpio_pps_client:*' -e 'pwdog:*' -e 'testsysfs:*' -a -- sleep 60
+#   perf script -s scripts/perf-driver-latency.py
+#
+# acpi_gpio_pps_client: interval between assert edges per client and its deviation from 1 s
+# pwdog:                keepalive interval and margin left to the timeout, interrupts
+# testsysfs:            stamps per source and start to stop durations per stopwatch
+
+from __future__ import print_function
+
+import math
+
+NSEC_PER_SEC = 1000000000
+
+STAMP_NAMES = {
+    1: "stamped_time",
+    2: "starttimer",
+    3: "stoptimer",
+    4: "ioctl",
+    5: "write",
+    6: "eventfd",
+}
+
+
+class Stats(object):
+    def __init__(self):
+        self.count = 0
+        self.total = 0.0
+        self.squares = 0.0
+        self.min = None
+        self.max = None
+
+    def add(self, value):
+        self.count += 1
+        self.total += value
+        self.squares += value * value
+        self.min = value if self.min is None else min(self.min, value)
+        self.max = value if self.max is None else max(self.max, value)
+
+    def line(self, unit):
+        if not self.count:
+            return "no samples"
+        mean = self.total / self.count
+        stddev = math.sqrt(max(self.squares / self.count - mean * mean, 0.0))
+        return "n=%d min=%d%s mean=%.1f%s max=%d%s stddev=%.1f%s" % (
+            self.count, self.min, unit, mean, unit, self.max, unit, stddev, unit)
+
+
+pps_last = {}
+pps_interval = {}
+pps_clear = {}
+pwdog_interval = Stats()
+pwdog_margin = Stats()
+pwdog_irqs = {"MSI": 0, "INTx": 0, "unhandled": 0}
+pwdog_starts = 0
+pwdog_stops = 0
+stamps = {}
+stopwatch_start = {}
+stopwatch_duration = {}
+
+
+def acpi_gpio_pps_client__acpi_gpio_pps_client_edge(event_name, context, common_cpu,
+                                                    common_secs, common_nsecs, common_pid,
+                                                    common_comm, common_callchain, client, irq,
+                                                    sec, nsec, assert_edge, compensation_ns,
+                                                    *unused):
+    if not assert_edge:
+        pps_clear[client] = pps_clear.get(client, 0) + 1
+        return
+
+    ts = sec * NSEC_PER_SEC + nsec
+    if client in pps_last:
+        pps_interval.setdefault(client, Stats()).add(ts - pps_last[client])
+    pps_last[client] = ts
+
+
+def pwdog__pwdog_start(event_name, context, common_cpu, common_secs, common_nsecs, common_pid,
+                       common_comm, common_callchain, id, timeout, *unused):
+    global pwdog_starts
+    pwdog_starts += 1
+
+
+def pwdog__pwdog_stop(event_name, context, common_cpu, common_secs, common_nsecs, common_pid,
+                      common_comm, common_callchain, id, timeout, *unused):
+    global pwdog_stops
+    pwdog_stops += 1
+
+
+def pwdog__pwdog_ping(event_name, context, common_cpu, common_secs, common_nsecs, common_pid,
+                      common_comm, common_callchain, id, timeout, interval_us, margin_us,
+                      *unused):
+    pwdog_interval.add(interval_us)
+    pwdog_margin.add(margin_us)
+
+
+def pwdog__pwdog_irq(event_name, context, common_cpu, common_secs, common_nsecs, common_pid,
+                     common_comm, common_callchain, irq, msi, intr_flag, handled, *unused):
+    if not handled:
+        pwdog_irqs["unhandled"] += 1
+    else:
+        pwdog_irqs["MSI" if msi else "INTx"] += 1
+
+
+def testsysfs__testsysfs_stamp(event_name, context, common_cpu, common_secs, common_nsecs,
+                               common_pid, common_comm, common_callchain, id, boottime_ns,
+                               *unused):
+    name = STAMP_NAMES.get(id, str(id))
+    stamps[name] = stamps.get(name, 0) + 1
+
+
+def testsysfs__testsysfs_stopwatch(event_name, context, common_cpu, common_secs, common_nsecs,
+                                   common_pid, common_comm, common_callchain, name, stop, ns,
+                                   *unused):
+    if not stop:
+        stopwatch_start[name] = ns
+    elif name in stopwatch_start:
+        stopwatch_duration.setdefault(name, Stats()).add(ns - stopwatch_start.pop(name))
+
+
+def trace_end():
+    if pps_interval or pps_clear:
+        print("acpi_gpio_pps_client assert intervals:")
+        for client in sorted(pps_interval):
+            stats = pps_interval[client]
+            print("  %-16s %s" % (client, stats.line("ns")))
+            if stats.count:
+                print("  %-16s offset from 1 s: mean=%.1fns" %
+                      ("", stats.total / stats.count - NSEC_PER_SEC))
+        for client in sorted(pps_clear):
+            print("  %-16s %d clear edges" % (client, pps_clear[client]))
+
+    if pwdog_interval.count or pwdog_starts or sum(pwdog_irqs.values()):
+        print("pwdog:")
+        print("  starts=%d stops=%d" % (pwdog_starts, pwdog_stops))
+        print("  ping interval %s" % pwdog_interval.line("us"))
+        print("  ping margin   %s" % pwdog_margin.line("us"))
+        print("  irqs MSI=%d INTx=%d unhandled=%d" %
+              (pwdog_irqs["MSI"], pwdog_irqs["INTx"], pwdog_irqs["unhandled"]))
+
+    if stamps or stopwatch_duration:
+        print("testsysfs:")
+        for name in sorted(stamps):
+            print("  %-16s %d stamps" % (name, stamps[name]))
+        for name in sorted(stopwatch_duration):
+            print("  %-16s %s" % (name, stopwatch_duration[name].line("ns")))
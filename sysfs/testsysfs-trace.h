@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * testsysfs - trace events
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM testsysfs
+
+#if !defined(_TESTSYSFS_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TESTSYSFS_TRACE_H
+
+#include <linux/tracepoint.h>
+
+/* a stamp of the global attributes or of /dev/testsysfs, id is one of TESTSYSFS_EVENT_* */
+TRACE_EVENT(testsysfs_stamp,
+
+	TP_PROTO(u32 id, u64 boottime_ns),
+
+	TP_ARGS(id, boottime_ns),
+
+	TP_STRUCT__entry(
+		__field(u32, id)
+		__field(u64, boottime_ns)
+	),
+
+	TP_fast_assign(
+		__entry->id = id;
+		__entry->boottime_ns = boottime_ns;
+	),
+
+	TP_printk("id=%u boottime_ns=%llu", __entry->id, __entry->boottime_ns)
+);
+
+/* a start or stop of a named stopwatch, ns is taken from the stopwatch's clock */
+TRACE_EVENT(testsysfs_stopwatch,
+
+	TP_PROTO(const char *name, bool stop, s64 ns),
+
+	TP_ARGS(name, stop, ns),
+
+	TP_STRUCT__entry(
+		__string(name, name)
+		__field(bool, stop)
+		__field(s64, ns)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, name);
+		__entry->stop = stop;
+		__entry->ns = ns;
+	),
+
+	TP_printk("name=%s %s ns=%lld", __get_str(name), __entry->stop ? "stop" : "start",
+		  __entry->ns)
+);
+
+#endif /* _TESTSYSFS_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE testsysfs-trace
+#include <trace/define_trace.h>
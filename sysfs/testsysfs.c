@@ -1,18 +1,602 @@
+#include <linux/atomic.h>
 #include <linux/device.h>
+#include <linux/eventfd.h>
+#include <linux/file.h>
+#include <linux/fs.h>
 #include <linux/init.h>
 #include <linux/kernel.h>
+#include <linux/kobject.h>
+#include <linux/list.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/poll.h>
 #include <linux/rtc.h>
+#include <linux/sched.h>
+#include <linux/seqlock.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
 #include <linux/time.h>
+#include <linux/timekeeping.h>
 #include <linux/types.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include <linux/wait.h>
+
+#include "testsysfs.h"
+
+#define CREATE_TRACE_POINTS
+#include "testsysfs-trace.h"
+
+#define STOPWATCH_NAME_LEN	32
+#define MAX_STOPWATCHES		64
+
+/*
+ * log-linear histogram of the stop - start differences in nanoseconds, every power of two is
+ * split into HIST_SUB linear sub-buckets (at most 1/HIST_SUB relative error), values beyond
+ * 2^HIST_MAX_EXP ns (about 4.9 hours) end up in the last bucket
+ */
+#define HIST_SUB_BITS	4
+#define HIST_SUB	(1 << HIST_SUB_BITS)
+#define HIST_MAX_EXP	44
+#define HIST_BUCKETS	((HIST_MAX_EXP - HIST_SUB_BITS + 1) * HIST_SUB)
+
+#define LOG_RECORDS	4096 /* per CPU, power of two */
+
+struct testsysfs_hist {
+	atomic64_t sum;
+	atomic64_t min;
+	atomic64_t max;
+	atomic64_t buckets[HIST_BUCKETS];
+};
+
+/* writers serialize on the seqlock, readers never block them and retry on a torn read */
+struct testsysfs_timer {
+	seqlock_t lock;
+	clockid_t clock;
+	struct timespec64 start;
+	struct timespec64 stop;
+	bool started;			/* a start is waiting for its stop */
+	struct testsysfs_hist hist;
+};
+
+/*
+ * single producer/single consumer ring per CPU, the producer is the local CPU with interrupts
+ * disabled, the consumer is serialized by log_lock; a full ring drops new records
+ */
+struct testsysfs_log {
+	u32 head;
+	u32 tail;
+	u64 dropped;
+	struct testsysfs_record *records;
+};
+
+/* per open file of the misc device */
+struct testsysfs_file {
+	struct mutex lock; /* protects eventfd */
+	struct eventfd_ctx *eventfd;
+	wait_queue_entry_t wait;
+	poll_table pt;
+};
+
+struct testsysfs_stopwatch {
+	struct kobject kobj;
+	struct list_head node;
+	struct testsysfs_timer timer;
+};
 
 static struct kobject *local_kobj = NULL;
-static struct timespec64 starttimer = {0, 0};
-static struct timespec64 stoptimer = {0, 0};
+static struct testsysfs_timer legacy_timer = {
+	.lock = __SEQLOCK_UNLOCKED(legacy_timer.lock),
+	.clock = CLOCK_BOOTTIME,
+};
+
+/* the clocks a stopwatch can use, same order in both */
+static const char * const testsysfs_clock_names[] = {
+	"realtime",
+	"monotonic",
+	"monotonic_raw",
+	"boottime",
+	"tai",
+};
+
+static const clockid_t testsysfs_clock_ids[] = {
+	CLOCK_REALTIME,
+	CLOCK_MONOTONIC,
+	CLOCK_MONOTONIC_RAW,
+	CLOCK_BOOTTIME,
+	CLOCK_TAI,
+};
+static LIST_HEAD(stopwatches);
+static DEFINE_MUTEX(stopwatches_lock);
+static unsigned int stopwatches_count;
+static struct testsysfs_page *page;
+static DEFINE_SPINLOCK(page_lock);
+static DEFINE_PER_CPU(struct testsysfs_log, logs);
+static DEFINE_MUTEX(log_lock);
 static ktime_t start_time = 0;
 static ktime_t mod_time = 0;
 static ktime_t stamped_time = 0;
 
+/*----- difference histogram -----*/
+
+static unsigned int testsysfs_hist_bucket(u64 ns)
+{
+	unsigned int exp;
+
+	if (ns < HIST_SUB)
+		return ns;
+
+	exp = ilog2(ns);
+	if (exp >= HIST_MAX_EXP)
+		return HIST_BUCKETS - 1;
+
+	return (exp - HIST_SUB_BITS + 1) * HIST_SUB + ((ns >> (exp - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+/* the middle of the value range a bucket covers */
+static u64 testsysfs_hist_value(unsigned int bucket)
+{
+	unsigned int exp, shift;
+
+	if (bucket < HIST_SUB)
+		return bucket;
+
+	exp = bucket / HIST_SUB + HIST_SUB_BITS - 1;
+	shift = exp - HIST_SUB_BITS;
+
+	return ((u64)(HIST_SUB + bucket % HIST_SUB) << shift) + ((1ULL << shift) >> 1);
+}
+
+/* not atomic against concurrent recording, a reset during a measurement may lose it */
+static void testsysfs_hist_reset(struct testsysfs_hist *hist)
+{
+	unsigned int i;
+
+	atomic64_set(&hist->min, S64_MAX);
+	atomic64_set(&hist->max, 0);
+	atomic64_set(&hist->sum, 0);
+	for (i = 0; i < HIST_BUCKETS; ++i)
+		atomic64_set(&hist->buckets[i], 0);
+}
+
+static void testsysfs_hist_add(struct testsysfs_hist *hist, s64 ns)
+{
+	s64 old;
+
+	atomic64_inc(&hist->buckets[testsysfs_hist_bucket(ns)]);
+	atomic64_add(ns, &hist->sum);
+
+	old = atomic64_read(&hist->min);
+	while (ns < old && !atomic64_try_cmpxchg(&hist->min, &old, ns))
+		;
+	old = atomic64_read(&hist->max);
+	while (ns > old && !atomic64_try_cmpxchg(&hist->max, &old, ns))
+		;
+}
+
+static ssize_t testsysfs_hist_emit(char *buf, struct testsysfs_hist *hist)
+{
+	static const unsigned int permille[] = { 500, 990, 999 };
+	u64 pct[ARRAY_SIZE(permille)] = { 0 };
+	u64 total = 0, seen = 0, target;
+	s64 min = atomic64_read(&hist->min);
+	s64 max = atomic64_read(&hist->max);
+	unsigned int i, p = 0;
+
+	/* the buckets are the reference, sum, min and max may be ahead of them by a few samples */
+	for (i = 0; i < HIST_BUCKETS; ++i)
+		total += atomic64_read(&hist->buckets[i]);
+	if (!total)
+		return sysfs_emit(buf, "count: 0\n");
+
+	for (i = 0; i < HIST_BUCKETS && p < ARRAY_SIZE(permille); ++i) {
+		seen += atomic64_read(&hist->buckets[i]);
+		target = DIV_ROUND_UP_ULL(total * permille[p], 1000);
+		while (p < ARRAY_SIZE(permille) && seen >= target) {
+			pct[p++] = clamp_t(s64, testsysfs_hist_value(i), min, max);
+			if (p < ARRAY_SIZE(permille))
+				target = DIV_ROUND_UP_ULL(total * permille[p], 1000);
+		}
+	}
+
+	return sysfs_emit(buf, "count: %llu\nmin_ns: %lld\nmax_ns: %lld\nmean_ns: %llu\n"
+			  "p50_ns: %llu\np99_ns: %llu\np999_ns: %llu\n", total, min, max,
+			  div64_u64(atomic64_read(&hist->sum), total),
+			  pct[0], pct[1], pct[2]);
+}
+
+/*----- timers -----*/
+
+static void testsysfs_clock_read(clockid_t clock, struct timespec64 *ts)
+{
+	switch (clock) {
+	case CLOCK_REALTIME:
+		ktime_get_real_ts64(ts);
+		break;
+	case CLOCK_MONOTONIC:
+		ktime_get_ts64(ts);
+		break;
+	case CLOCK_MONOTONIC_RAW:
+		ktime_get_raw_ts64(ts);
+		break;
+	case CLOCK_TAI:
+		*ts = ktime_to_timespec64(ktime_get_clocktai());
+		break;
+	default:
+		ktime_get_boottime_ts64(ts);
+		break;
+	}
+}
+
+/* returns the new time stamp in nanoseconds */
+static s64 testsysfs_timer_stamp(struct testsysfs_timer *timer, bool stop)
+{
+	struct timespec64 now, start;
+	bool sample = false;
+
+	/* read under the lock, so a concurrent clock change cannot mix two clocks */
+	write_seqlock(&timer->lock);
+	testsysfs_clock_read(timer->clock, &now);
+	if (stop) {
+		timer->stop = now;
+		/* the first stop consumes the start, so every pair is exactly one sample */
+		sample = timer->started;
+		timer->started = false;
+	} else {
+		timer->start = now;
+		timer->started = true;
+	}
+	start = timer->start;
+	write_sequnlock(&timer->lock);
+
+	if (sample && timespec64_compare(&now, &start) >= 0)
+		testsysfs_hist_add(&timer->hist, timespec64_to_ns(&now) - timespec64_to_ns(&start));
+
+	return timespec64_to_ns(&now);
+}
+
+static void testsysfs_timer_read(struct testsysfs_timer *timer, struct timespec64 *start,
+				 struct timespec64 *stop)
+{
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&timer->lock);
+		*start = timer->start;
+		*stop = timer->stop;
+	} while (read_seqretry(&timer->lock, seq));
+}
+
+static ssize_t testsysfs_timer_emit(char *buf, struct testsysfs_timer *timer, bool stop)
+{
+	struct timespec64 start, end;
+	struct timespec64 *ts = stop ? &end : &start;
+
+	testsysfs_timer_read(timer, &start, &end);
+	if (ts->tv_sec || ts->tv_nsec)
+		return sysfs_emit(buf, "%020lld.%010ld\n", ts->tv_sec, ts->tv_nsec);
+
+	return sysfs_emit(buf, "N/A\n");
+}
+
+static ssize_t testsysfs_timer_diff_emit(char *buf, struct testsysfs_timer *timer)
+{
+	struct timespec64 start, stop, diff;
+
+	testsysfs_timer_read(timer, &start, &stop);
+	diff = timespec64_sub(stop, start);
+	if (diff.tv_sec >= 0 && diff.tv_nsec >= 0)
+		return sysfs_emit(buf, "%020lld.%010ld\n", diff.tv_sec, diff.tv_nsec);
+
+	return sysfs_emit(buf, "N/A\n");
+}
+
+/*----- mmap-able time stamp page -----*/
+
+static void testsysfs_page_update(void)
+{
+	struct timespec64 start, stop;
+	unsigned long flags;
+
+	/* the values are read under the lock, so a slower writer cannot publish stale ones */
+	spin_lock_irqsave(&page_lock, flags);
+	testsysfs_timer_read(&legacy_timer, &start, &stop);
+
+	WRITE_ONCE(page->seq, page->seq + 1);
+	smp_wmb();
+	page->start_time = start_time;
+	page->mod_time = mod_time;
+	page->stamped_time = stamped_time;
+	page->starttimer = timespec64_to_ns(&start);
+	page->stoptimer = timespec64_to_ns(&stop);
+	smp_wmb();
+	WRITE_ONCE(page->seq, page->seq + 1);
+	spin_unlock_irqrestore(&page_lock, flags);
+}
+
+static int testsysfs_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	if (vma->vm_pgoff || vma->vm_end - vma->vm_start > PAGE_SIZE)
+		return -EINVAL;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return remap_vmalloc_range(vma, page, 0);
+}
+
+/*----- per-CPU event log -----*/
+
+static void testsysfs_log(u32 id)
+{
+	struct testsysfs_record *rec;
+	struct testsysfs_log *log;
+	unsigned long flags;
+	u64 now;
+	u32 head;
+
+	local_irq_save(flags);
+	now = ktime_get_boottime_ns();
+	trace_testsysfs_stamp(id, now);
+	log = this_cpu_ptr(&logs);
+	head = log->head;
+	if (head - smp_load_acquire(&log->tail) >= LOG_RECORDS) {
+		log->dropped++;
+	} else {
+		rec = &log->records[head & (LOG_RECORDS - 1)];
+		rec->clock = now;
+		rec->cpu = smp_processor_id();
+		rec->pid = task_pid_nr(current);
+		rec->id = id;
+		rec->reserved = 0;
+		smp_store_release(&log->head, head + 1);
+	}
+	local_irq_restore(flags);
+}
+
+/* copies whole records only, the records of one CPU are in order, across CPUs they are not */
+static ssize_t testsysfs_log_read(char __user *buf, size_t count)
+{
+	size_t max = count / sizeof(struct testsysfs_record);
+	struct testsysfs_log *log;
+	size_t copied = 0;
+	u32 head, tail, n, off, chunk;
+	unsigned int cpu;
+	int err = 0;
+
+	mutex_lock(&log_lock);
+	for_each_possible_cpu(cpu) {
+		log = per_cpu_ptr(&logs, cpu);
+		head = smp_load_acquire(&log->head);
+		tail = log->tail;
+		n = min_t(size_t, head - tail, max - copied);
+
+		while (n) {
+			off = tail & (LOG_RECORDS - 1);
+			chunk = min_t(u32, n, LOG_RECORDS - off);
+			if (copy_to_user(buf + copied * sizeof(*log->records), &log->records[off],
+					 chunk * sizeof(*log->records))) {
+				err = -EFAULT;
+				break;
+			}
+			copied += chunk;
+			tail += chunk;
+			n -= chunk;
+		}
+
+		smp_store_release(&log->tail, tail);
+		if (err || copied == max)
+			break;
+	}
+	mutex_unlock(&log_lock);
+
+	if (err && !copied)
+		return err;
+
+	return copied * sizeof(struct testsysfs_record);
+}
+
+static int testsysfs_log_alloc(void)
+{
+	struct testsysfs_log *log;
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu) {
+		log = per_cpu_ptr(&logs, cpu);
+		log->records = kvzalloc_node(LOG_RECORDS * sizeof(*log->records), GFP_KERNEL,
+					     cpu_to_node(cpu));
+		if (!log->records)
+			return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void testsysfs_log_free(void)
+{
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu)
+		kvfree(per_cpu_ptr(&logs, cpu)->records);
+}
+
+/*----- stamp paths -----*/
+
+/* the same as a write to stamped_time, all other paths end up here */
+static void testsysfs_stamp(u32 id)
+{
+	mod_time = stamped_time = ktime_get_real();
+	testsysfs_log(id);
+	testsysfs_page_update();
+}
+
+/* called with the eventfd wait queue lock held, possibly with interrupts disabled */
+static int testsysfs_eventfd_wakeup(wait_queue_entry_t *wait, unsigned int mode, int sync,
+				    void *key)
+{
+	struct testsysfs_file *tf = container_of(wait, struct testsysfs_file, wait);
+	u64 cnt;
+
+	if (key_to_poll(key) & EPOLLIN) {
+		eventfd_ctx_do_read(tf->eventfd, &cnt);
+		testsysfs_stamp(TESTSYSFS_EVENT_EVENTFD);
+	}
+
+	return 0;
+}
+
+static void testsysfs_eventfd_queue(struct file *file, wait_queue_head_t *wqh, poll_table *pt)
+{
+	struct testsysfs_file *tf = container_of(pt, struct testsysfs_file, pt);
+
+	add_wait_queue(wqh, &tf->wait);
+}
+
+/* needs tf->lock */
+static void testsysfs_eventfd_detach(struct testsysfs_file *tf)
+{
+	u64 cnt;
+
+	if (!tf->eventfd)
+		return;
+
+	eventfd_ctx_remove_wait_queue(tf->eventfd, &tf->wait, &cnt);
+	eventfd_ctx_put(tf->eventfd);
+	tf->eventfd = NULL;
+}
+
+/* every write to the eventfd stamps synchronously from the wakeup, like a KVM irqfd */
+static int testsysfs_eventfd_attach(struct testsysfs_file *tf, int fd)
+{
+	struct eventfd_ctx *ctx;
+	struct fd f;
+	int err = 0;
+
+	mutex_lock(&tf->lock);
+	testsysfs_eventfd_detach(tf);
+	if (fd < 0)
+		goto out;
+
+	f = fdget(fd);
+	if (!f.file) {
+		err = -EBADF;
+		goto out;
+	}
+
+	ctx = eventfd_ctx_fileget(f.file);
+	if (IS_ERR(ctx)) {
+		err = PTR_ERR(ctx);
+		goto put;
+	}
+
+	tf->eventfd = ctx;
+	init_waitqueue_func_entry(&tf->wait, testsysfs_eventfd_wakeup);
+	init_poll_funcptr(&tf->pt, testsysfs_eventfd_queue);
+	vfs_poll(f.file, &tf->pt);
+
+put:
+	fdput(f);
+out:
+	mutex_unlock(&tf->lock);
+
+	return err;
+}
+
+static int testsysfs_open(struct inode *inode, struct file *file)
+{
+	struct testsysfs_file *tf;
+
+	tf = kzalloc(sizeof(*tf), GFP_KERNEL);
+	if (!tf)
+		return -ENOMEM;
+
+	mutex_init(&tf->lock);
+	file->private_data = tf;
+
+	return 0;
+}
+
+static int testsysfs_release(struct inode *inode, struct file *file)
+{
+	struct testsysfs_file *tf = file->private_data;
+
+	mutex_lock(&tf->lock);
+	testsysfs_eventfd_detach(tf);
+	mutex_unlock(&tf->lock);
+	kfree(tf);
+
+	return 0;
+}
+
+/*
+ * draining takes the records away from the real consumer, so it needs the same write access as
+ * the ioctls, the page stays mappable for everybody
+ */
+static ssize_t testsysfs_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
+{
+	if (!(file->f_mode & FMODE_WRITE))
+		return -EBADF;
+
+	return testsysfs_log_read(buf, count);
+}
+
+static ssize_t testsysfs_write(struct file *file, const char __user *buf, size_t count,
+			       loff_t *ppos)
+{
+	testsysfs_stamp(TESTSYSFS_EVENT_WRITE);
+
+	return count;
+}
+
+static long testsysfs_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct testsysfs_file *tf = file->private_data;
+	__s32 fd;
+
+	if (!(file->f_mode & FMODE_WRITE))
+		return -EBADF;
+
+	switch (cmd) {
+	case TESTSYSFS_IOC_STAMP:
+		testsysfs_stamp(TESTSYSFS_EVENT_IOCTL);
+		return 0;
+	case TESTSYSFS_IOC_EVENTFD:
+		if (get_user(fd, (__s32 __user *)arg))
+			return -EFAULT;
+		return testsysfs_eventfd_attach(tf, fd);
+	default:
+		return -ENOTTY;
+	}
+}
+
+static const struct file_operations testsysfs_fops = {
+	.owner		= THIS_MODULE,
+	.open		= testsysfs_open,
+	.release	= testsysfs_release,
+	.read		= testsysfs_read,
+	.write		= testsysfs_write,
+	.unlocked_ioctl	= testsysfs_ioctl,
+	.compat_ioctl	= compat_ptr_ioctl,
+	.mmap		= testsysfs_mmap,
+	.llseek		= noop_llseek,
+};
+
+static struct miscdevice testsysfs_misc = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= "testsysfs",
+	.fops	= &testsysfs_fops,
+	.mode	= 0644,
+};
+
+/*----- attributes -----*/
+
 static ssize_t testsysfs_start_time_show(struct device *dev, struct device_attribute *attr,
 					 char *buf)
 {
@@ -63,7 +647,7 @@ static ssize_t testsysfs_stamped_time_show(struct device *dev, struct device_att
 static ssize_t testsysfs_stamped_time_store(struct device *dev, struct device_attribute *attr,
 					    const char *buf, size_t count)
 {
-	mod_time = stamped_time = ktime_get_real();
+	testsysfs_stamp(TESTSYSFS_EVENT_STAMPED_TIME);
 
 	return 1;
 }
@@ -80,17 +664,16 @@ static struct device_attribute testsysfs_stamped_time_dev_attr = {
 static ssize_t testsysfs_starttimer_show(struct device *dev, struct device_attribute *attr,
 					 char *buf)
 {
-	if (starttimer.tv_sec || starttimer.tv_nsec)
-		return sysfs_emit(buf, "%020lld.%010ld\n", starttimer.tv_sec, starttimer.tv_nsec);
-
-	return sysfs_emit(buf, "N/A\n");
+	return testsysfs_timer_emit(buf, &legacy_timer, false);
 }
 
 static ssize_t testsysfs_starttimer_store(struct device *dev, struct device_attribute *attr,
 					  const char *buf, size_t count)
 {
-	ktime_get_boottime_ts64(&starttimer);
+	testsysfs_timer_stamp(&legacy_timer, false);
 	mod_time = ktime_get_real();
+	testsysfs_log(TESTSYSFS_EVENT_STARTTIMER);
+	testsysfs_page_update();
 
 	return 1;
 }
@@ -107,17 +690,16 @@ static struct device_attribute testsysfs_starttimer_dev_attr = {
 static ssize_t testsysfs_stoptimer_show(struct device *dev, struct device_attribute *attr,
 					char *buf)
 {
-	if (stoptimer.tv_sec || stoptimer.tv_nsec)
-		return sysfs_emit(buf, "%020lld.%010ld\n", stoptimer.tv_sec, stoptimer.tv_nsec);
-
-	return sysfs_emit(buf, "N/A\n");
+	return testsysfs_timer_emit(buf, &legacy_timer, true);
 }
 
 static ssize_t testsysfs_stoptimer_store(struct device *dev, struct device_attribute *attr,
 					 const char *buf, size_t count)
 {
-	ktime_get_boottime_ts64(&stoptimer);
+	testsysfs_timer_stamp(&legacy_timer, true);
 	mod_time = ktime_get_real();
+	testsysfs_log(TESTSYSFS_EVENT_STOPTIMER);
+	testsysfs_page_update();
 
 	return 1;
 }
@@ -134,12 +716,7 @@ static struct device_attribute testsysfs_stoptimer_dev_attr = {
 static ssize_t testsysfs_difftimer_show(struct device *dev, struct device_attribute *attr,
 					char *buf)
 {
-	struct timespec64 diff = timespec64_sub(stoptimer, starttimer);
-
-	if (diff.tv_sec >= 0 && diff.tv_nsec >= 0)
-		return sysfs_emit(buf, "%020lld.%010ld\n", diff.tv_sec, diff.tv_nsec);
-
-	return sysfs_emit(buf, "N/A\n");
+	return testsysfs_timer_diff_emit(buf, &legacy_timer);
 }
 
 static struct device_attribute testsysfs_difftimer_dev_attr = {
@@ -150,6 +727,399 @@ static struct device_attribute testsysfs_difftimer_dev_attr = {
         .show = testsysfs_difftimer_show,
 };
 
+static ssize_t testsysfs_histogram_show(struct device *dev, struct device_attribute *attr,
+					char *buf)
+{
+	return testsysfs_hist_emit(buf, &legacy_timer.hist);
+}
+
+static struct device_attribute testsysfs_histogram_dev_attr = {
+	.attr = {
+		.name = "histogram",
+		.mode = S_IRUGO,
+	},
+	.show = testsysfs_histogram_show,
+};
+
+static ssize_t testsysfs_histogram_reset_store(struct device *dev, struct device_attribute *attr,
+					       const char *buf, size_t count)
+{
+	testsysfs_hist_reset(&legacy_timer.hist);
+
+	return count;
+}
+
+static struct device_attribute testsysfs_histogram_reset_dev_attr = {
+	.attr = {
+		.name = "histogram_reset",
+		.mode = S_IWUSR,
+	},
+	.store = testsysfs_histogram_reset_store,
+};
+
+static ssize_t testsysfs_log_dropped_show(struct device *dev, struct device_attribute *attr,
+					  char *buf)
+{
+	unsigned int cpu;
+	u64 dropped = 0;
+
+	for_each_possible_cpu(cpu)
+		dropped += READ_ONCE(per_cpu_ptr(&logs, cpu)->dropped);
+
+	return sysfs_emit(buf, "%llu\n", dropped);
+}
+
+static struct device_attribute testsysfs_log_dropped_dev_attr = {
+	.attr = {
+		.name = "log_dropped",
+		.mode = S_IRUGO,
+	},
+	.show = testsysfs_log_dropped_show,
+};
+
+/*
+ * all clocks at one instant: realtime, raw and the cycles come from one timekeeper read,
+ * the other clocks are derived from its monotonic time with the current offsets
+ */
+static ssize_t testsysfs_snapshot_read(struct file *file, struct kobject *kobj,
+				       struct bin_attribute *attr, char *buf, loff_t off,
+				       size_t count)
+{
+	struct system_time_snapshot snap, check;
+	struct testsysfs_snapshot out;
+	ktime_t mono, boot, tai;
+
+	/*
+	 * The offsets are read after the snapshot, every change of them (settimeofday, resume, leap
+	 * second) bumps clock_was_set_seq, so retry until none happened in between.
+	 */
+	do {
+		ktime_get_snapshot(&snap);
+		mono = ktime_sub(snap.real, ktime_mono_to_real(0));
+		boot = ktime_mono_to_any(mono, TK_OFFS_BOOT);
+		tai = ktime_mono_to_any(mono, TK_OFFS_TAI);
+		ktime_get_snapshot(&check);
+	} while (check.clock_was_set_seq != snap.clock_was_set_seq);
+
+	out.realtime = ktime_to_ns(snap.real);
+	out.monotonic = ktime_to_ns(mono);
+	out.monotonic_raw = ktime_to_ns(snap.raw);
+	out.boottime = ktime_to_ns(boot);
+	out.tai = ktime_to_ns(tai);
+	out.cycles = snap.cycles;
+
+	return memory_read_from_buffer(buf, count, &off, &out, sizeof(out));
+}
+
+static struct bin_attribute testsysfs_snapshot_attr = {
+	.attr = {
+		.name = "snapshot",
+		.mode = S_IRUGO,
+	},
+	.size = sizeof(struct testsysfs_snapshot),
+	.read = testsysfs_snapshot_read,
+};
+
+/*----- named stopwatches -----*/
+
+#define to_stopwatch(k) container_of(k, struct testsysfs_stopwatch, kobj)
+
+static ssize_t testsysfs_stopwatch_start_show(struct kobject *kobj, struct kobj_attribute *attr,
+					      char *buf)
+{
+	return testsysfs_timer_emit(buf, &to_stopwatch(kobj)->timer, false);
+}
+
+static ssize_t testsysfs_stopwatch_start_store(struct kobject *kobj, struct kobj_attribute *attr,
+					       const char *buf, size_t count)
+{
+	s64 ns = testsysfs_timer_stamp(&to_stopwatch(kobj)->timer, false);
+
+	trace_testsysfs_stopwatch(kobject_name(kobj), false, ns);
+
+	return count;
+}
+
+static struct kobj_attribute testsysfs_stopwatch_start_attr = {
+	.attr = {
+		.name = "starttimer",
+		.mode = S_IWUSR | S_IRUGO,
+	},
+	.show = testsysfs_stopwatch_start_show,
+	.store = testsysfs_stopwatch_start_store,
+};
+
+static ssize_t testsysfs_stopwatch_stop_show(struct kobject *kobj, struct kobj_attribute *attr,
+					     char *buf)
+{
+	return testsysfs_timer_emit(buf, &to_stopwatch(kobj)->timer, true);
+}
+
+static ssize_t testsysfs_stopwatch_stop_store(struct kobject *kobj, struct kobj_attribute *attr,
+					      const char *buf, size_t count)
+{
+	s64 ns = testsysfs_timer_stamp(&to_stopwatch(kobj)->timer, true);
+
+	trace_testsysfs_stopwatch(kobject_name(kobj), true, ns);
+
+	return count;
+}
+
+static struct kobj_attribute testsysfs_stopwatch_stop_attr = {
+	.attr = {
+		.name = "stoptimer",
+		.mode = S_IWUSR | S_IRUGO,
+	},
+	.show = testsysfs_stopwatch_stop_show,
+	.store = testsysfs_stopwatch_stop_store,
+};
+
+static ssize_t testsysfs_stopwatch_diff_show(struct kobject *kobj, struct kobj_attribute *attr,
+					     char *buf)
+{
+	return testsysfs_timer_diff_emit(buf, &to_stopwatch(kobj)->timer);
+}
+
+static struct kobj_attribute testsysfs_stopwatch_diff_attr = {
+	.attr = {
+		.name = "difftimer",
+		.mode = S_IRUGO,
+	},
+	.show = testsysfs_stopwatch_diff_show,
+};
+
+static ssize_t testsysfs_stopwatch_histogram_show(struct kobject *kobj,
+						  struct kobj_attribute *attr, char *buf)
+{
+	return testsysfs_hist_emit(buf, &to_stopwatch(kobj)->timer.hist);
+}
+
+static struct kobj_attribute testsysfs_stopwatch_histogram_attr = {
+	.attr = {
+		.name = "histogram",
+		.mode = S_IRUGO,
+	},
+	.show = testsysfs_stopwatch_histogram_show,
+};
+
+static ssize_t testsysfs_stopwatch_histogram_reset_store(struct kobject *kobj,
+							 struct kobj_attribute *attr,
+							 const char *buf, size_t count)
+{
+	testsysfs_hist_reset(&to_stopwatch(kobj)->timer.hist);
+
+	return count;
+}
+
+static struct kobj_attribute testsysfs_stopwatch_histogram_reset_attr = {
+	.attr = {
+		.name = "histogram_reset",
+		.mode = S_IWUSR,
+	},
+	.store = testsysfs_stopwatch_histogram_reset_store,
+};
+
+static ssize_t testsysfs_stopwatch_clock_show(struct kobject *kobj, struct kobj_attribute *attr,
+					      char *buf)
+{
+	clockid_t clock = READ_ONCE(to_stopwatch(kobj)->timer.clock);
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(testsysfs_clock_ids); ++i)
+		if (testsysfs_clock_ids[i] == clock)
+			return sysfs_emit(buf, "%s\n", testsysfs_clock_names[i]);
+
+	return sysfs_emit(buf, "N/A\n");
+}
+
+/* a different clock makes the old time stamps and the histogram meaningless */
+static ssize_t testsysfs_stopwatch_clock_store(struct kobject *kobj, struct kobj_attribute *attr,
+					       const char *buf, size_t count)
+{
+	struct testsysfs_timer *timer = &to_stopwatch(kobj)->timer;
+	int i;
+
+	i = sysfs_match_string(testsysfs_clock_names, buf);
+	if (i < 0)
+		return i;
+
+	write_seqlock(&timer->lock);
+	timer->clock = testsysfs_clock_ids[i];
+	timer->start = (struct timespec64){ 0, 0 };
+	timer->stop = (struct timespec64){ 0, 0 };
+	timer->started = false;
+	write_sequnlock(&timer->lock);
+	testsysfs_hist_reset(&timer->hist);
+
+	return count;
+}
+
+static struct kobj_attribute testsysfs_stopwatch_clock_attr = {
+	.attr = {
+		.name = "clock",
+		.mode = S_IWUSR | S_IRUGO,
+	},
+	.show = testsysfs_stopwatch_clock_show,
+	.store = testsysfs_stopwatch_clock_store,
+};
+
+static struct attribute *testsysfs_stopwatch_attrs[] = {
+	&testsysfs_stopwatch_clock_attr.attr,
+	&testsysfs_stopwatch_start_attr.attr,
+	&testsysfs_stopwatch_stop_attr.attr,
+	&testsysfs_stopwatch_diff_attr.attr,
+	&testsysfs_stopwatch_histogram_attr.attr,
+	&testsysfs_stopwatch_histogram_reset_attr.attr,
+	NULL,
+};
+ATTRIBUTE_GROUPS(testsysfs_stopwatch);
+
+static void testsysfs_stopwatch_release(struct kobject *kobj)
+{
+	kfree(to_stopwatch(kobj));
+}
+
+static struct kobj_type testsysfs_stopwatch_ktype = {
+	.release = testsysfs_stopwatch_release,
+	.sysfs_ops = &kobj_sysfs_ops,
+	.default_groups = testsysfs_stopwatch_groups,
+};
+
+/* needs stopwatches_lock */
+static struct testsysfs_stopwatch *testsysfs_stopwatch_find(const char *name)
+{
+	struct testsysfs_stopwatch *sw;
+
+	list_for_each_entry(sw, &stopwatches, node)
+		if (!strcmp(kobject_name(&sw->kobj), name))
+			return sw;
+
+	return NULL;
+}
+
+static int testsysfs_stopwatch_name(char *name, const char *buf, size_t count)
+{
+	char *trimmed;
+
+	if (count >= STOPWATCH_NAME_LEN)
+		return -ENAMETOOLONG;
+
+	memcpy(name, buf, count);
+	name[count] = '\0';
+	trimmed = strim(name);
+	memmove(name, trimmed, strlen(trimmed) + 1);
+	/* "." and ".." would alias the directory itself or its parent */
+	if (!name[0] || strchr(name, '/') || !strcmp(name, ".") || !strcmp(name, ".."))
+		return -EINVAL;
+
+	return 0;
+}
+
+static ssize_t testsysfs_create_store(struct device *dev, struct device_attribute *attr,
+				      const char *buf, size_t count)
+{
+	char name[STOPWATCH_NAME_LEN];
+	struct testsysfs_stopwatch *sw;
+	struct kernfs_node *kn;
+	int err;
+
+	err = testsysfs_stopwatch_name(name, buf, count);
+	if (err)
+		return err;
+
+	mutex_lock(&stopwatches_lock);
+	/* the name must neither be taken by another stopwatch nor by one of the attributes */
+	kn = sysfs_get_dirent(local_kobj->sd, name);
+	if (kn) {
+		sysfs_put(kn);
+		err = -EEXIST;
+		goto out;
+	}
+	if (stopwatches_count >= MAX_STOPWATCHES) {
+		err = -ENOSPC;
+		goto out;
+	}
+
+	sw = kzalloc(sizeof(*sw), GFP_KERNEL);
+	if (!sw) {
+		err = -ENOMEM;
+		goto out;
+	}
+	seqlock_init(&sw->timer.lock);
+	sw->timer.clock = CLOCK_BOOTTIME;
+	testsysfs_hist_reset(&sw->timer.hist);
+
+	err = kobject_init_and_add(&sw->kobj, &testsysfs_stopwatch_ktype, local_kobj, "%s", name);
+	if (err) {
+		kobject_put(&sw->kobj);
+		goto out;
+	}
+
+	list_add_tail(&sw->node, &stopwatches);
+	stopwatches_count++;
+
+out:
+	mutex_unlock(&stopwatches_lock);
+
+	return err ? err : count;
+}
+
+static struct device_attribute testsysfs_create_dev_attr = {
+	.attr = {
+		.name = "create",
+		.mode = S_IWUSR,
+	},
+	.store = testsysfs_create_store,
+};
+
+static ssize_t testsysfs_destroy_store(struct device *dev, struct device_attribute *attr,
+				       const char *buf, size_t count)
+{
+	char name[STOPWATCH_NAME_LEN];
+	struct testsysfs_stopwatch *sw;
+	int err;
+
+	err = testsysfs_stopwatch_name(name, buf, count);
+	if (err)
+		return err;
+
+	mutex_lock(&stopwatches_lock);
+	sw = testsysfs_stopwatch_find(name);
+	if (sw) {
+		list_del(&sw->node);
+		stopwatches_count--;
+	}
+	mutex_unlock(&stopwatches_lock);
+
+	if (!sw)
+		return -ENOENT;
+
+	kobject_put(&sw->kobj);
+
+	return count;
+}
+
+static struct device_attribute testsysfs_destroy_dev_attr = {
+	.attr = {
+		.name = "destroy",
+		.mode = S_IWUSR,
+	},
+	.store = testsysfs_destroy_store,
+};
+
+static void testsysfs_stopwatches_destroy(void)
+{
+	struct testsysfs_stopwatch *sw, *tmp;
+
+	mutex_lock(&stopwatches_lock);
+	list_for_each_entry_safe(sw, tmp, &stopwatches, node) {
+		list_del(&sw->node);
+		kobject_put(&sw->kobj);
+	}
+	stopwatches_count = 0;
+	mutex_unlock(&stopwatches_lock);
+}
+
 static const struct attribute *testsysfs_attrs[] = {
 	&testsysfs_start_time_dev_attr.attr,
 	&testsysfs_mod_time_dev_attr.attr,
@@ -157,6 +1127,11 @@ static const struct attribute *testsysfs_attrs[] = {
 	&testsysfs_starttimer_dev_attr.attr,
 	&testsysfs_stoptimer_dev_attr.attr,
 	&testsysfs_difftimer_dev_attr.attr,
+	&testsysfs_histogram_dev_attr.attr,
+	&testsysfs_histogram_reset_dev_attr.attr,
+	&testsysfs_log_dropped_dev_attr.attr,
+	&testsysfs_create_dev_attr.attr,
+	&testsysfs_destroy_dev_attr.attr,
 	NULL,
 };
 
@@ -165,11 +1140,23 @@ static int __init testsysfs_init(void)
 	int err = 0;
 
 	start_time = ktime_get_real();
+	testsysfs_hist_reset(&legacy_timer.hist);
+
+	page = vmalloc_user(PAGE_SIZE);
+	if (!page)
+		return -ENOMEM;
+	page->version = TESTSYSFS_PAGE_VERSION;
+	page->start_time = start_time;
+
+	err = testsysfs_log_alloc();
+	if (err)
+		goto log_fail;
 
 	local_kobj = kobject_create_and_add("testsysfs", kernel_kobj);
 	if (!local_kobj) {
 		pr_err("unable to create kobject\n");
-		return -ENOMEM;
+		err = -ENOMEM;
+		goto log_fail;
 	}
 
 	err = sysfs_create_files(local_kobj, testsysfs_attrs);
@@ -178,10 +1165,29 @@ static int __init testsysfs_init(void)
 		goto kobj_fail;
 	}
 
+	err = sysfs_create_bin_file(local_kobj, &testsysfs_snapshot_attr);
+	if (err) {
+		pr_err("failed to create sysfs entry (%d)\n", err);
+		goto files_fail;
+	}
+
+	err = misc_register(&testsysfs_misc);
+	if (err) {
+		pr_err("failed to register misc device (%d)\n", err);
+		goto bin_fail;
+	}
+
 	return 0;
 
+bin_fail:
+	sysfs_remove_bin_file(local_kobj, &testsysfs_snapshot_attr);
+files_fail:
+	sysfs_remove_files(local_kobj, testsysfs_attrs);
 kobj_fail:
 	kobject_put(local_kobj);
+log_fail:
+	testsysfs_log_free();
+	vfree(page);
 
 	return err;
 }
@@ -189,8 +1195,13 @@ module_init(testsysfs_init);
 
 static void __exit testsysfs_exit(void)
 {
+	misc_deregister(&testsysfs_misc);
+	sysfs_remove_bin_file(local_kobj, &testsysfs_snapshot_attr);
 	sysfs_remove_files(local_kobj, testsysfs_attrs);
+	testsysfs_stopwatches_destroy();
 	kobject_put(local_kobj);
+	testsysfs_log_free();
+	vfree(page);
 }
 module_exit(testsysfs_exit);
 
@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note */
+/*
+ * testsysfs - userspace interface of the testsysfs device
+ * Copyright (C) 2021 Wilken Gottwalt
+ */
+
+#ifndef _TESTSYSFS_H
+#define _TESTSYSFS_H
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define TESTSYSFS_PAGE_VERSION	1
+
+/*
+ * Stamp operations of /dev/testsysfs, all of them do the same as a write to the stamped_time
+ * attribute. A write() of any data stamps as well. TESTSYSFS_IOC_EVENTFD binds an eventfd to the
+ * open file, every write to that eventfd then stamps synchronously, a negative fd unbinds it.
+ * Both need the device to be opened for writing.
+ */
+#define TESTSYSFS_IOC_MAGIC	'T'
+#define TESTSYSFS_IOC_STAMP	_IO(TESTSYSFS_IOC_MAGIC, 0x01)
+#define TESTSYSFS_IOC_EVENTFD	_IOW(TESTSYSFS_IOC_MAGIC, 0x02, __s32)
+
+/*
+ * The read-only page behind mmap() of /dev/testsysfs. All times are raw ktime values in
+ * nanoseconds, 0 means not set yet. start_time, mod_time and stamped_time are CLOCK_REALTIME,
+ * starttimer and stoptimer are CLOCK_BOOTTIME.
+ *
+ * 'seq' is odd while the driver updates the page. A reader copies the values between two reads
+ * of 'seq' (with read barriers in between) and retries if it was odd or changed.
+ */
+struct testsysfs_page {
+	__u32 version;
+	__u32 seq;
+	__s64 start_time;
+	__s64 mod_time;
+	__s64 stamped_time;
+	__s64 starttimer;
+	__s64 stoptimer;
+};
+
+/*
+ * The content of the binary snapshot attribute, all clocks in nanoseconds taken at the same
+ * instant. 'cycles' is the raw counter value of the current clocksource at that instant.
+ */
+struct testsysfs_snapshot {
+	__s64 realtime;
+	__s64 monotonic;
+	__s64 monotonic_raw;
+	__s64 boottime;
+	__s64 tai;
+	__u64 cycles;
+};
+
+/* the source of an event log record */
+#define TESTSYSFS_EVENT_STAMPED_TIME	1
+#define TESTSYSFS_EVENT_STARTTIMER	2
+#define TESTSYSFS_EVENT_STOPTIMER	3
+#define TESTSYSFS_EVENT_IOCTL		4
+#define TESTSYSFS_EVENT_WRITE		5
+#define TESTSYSFS_EVENT_EVENTFD		6
+
+/*
+ * One stamp operation as returned by read() of /dev/testsysfs, a read returns as many whole
+ * records as fit into the buffer and 0 if there are none. 'clock' is CLOCK_BOOTTIME in
+ * nanoseconds, 'pid' is the thread id of the stamping task.
+ */
+struct testsysfs_record {
+	__u64 clock;
+	__u32 cpu;
+	__u32 pid;
+	__u32 id;
+	__u32 reserved;
+};
+
+#endif
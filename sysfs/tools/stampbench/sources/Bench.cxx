@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Bench.hxx"
+
+namespace Stamp
+{
+    namespace
+    {
+        struct ThreadStats {
+            uint64_t stamps = 0;
+            int64_t latencyMin = std::numeric_limits<int64_t>::max();
+            int64_t latencyMax = 0;
+            int64_t latencySum = 0;
+            bool failed = false;
+        };
+    }
+
+    //--- public constructors ---
+
+    Bench::Bench(const std::string &devname, const std::string &attrname) noexcept
+    : _devname(devname), _attrname(attrname)
+    {
+    }
+
+    Bench::~Bench() noexcept
+    {
+    }
+
+    //--- public methods ---
+
+    bool Bench::run(const Channel::Type type, const uint32_t threads, const uint32_t duration_ms,
+                    Result &result) noexcept
+    {
+        try
+        {
+            std::vector<std::unique_ptr<Channel>> channels;
+            std::vector<ThreadStats> stats(threads);
+            std::vector<std::thread> workers;
+            std::atomic<bool> go(false);
+            std::atomic<bool> done(false);
+
+            // all channels are opened up front, so the setup does not end up in the numbers
+            for (uint32_t i = 0; i < threads; ++i)
+                channels.emplace_back(new Channel(type, _devname, _attrname));
+
+            auto worker = [&](const uint32_t i)
+            {
+                Channel &channel = *channels[i];
+
+                // the neighbouring entries of stats share cache lines, so the loop works on a
+                // local copy and the result is written back once
+                ThreadStats st;
+
+                while (!go)
+                    std::this_thread::yield();
+
+                while (!done)
+                {
+                    const auto t0 = std::chrono::steady_clock::now();
+
+                    if (!channel.stamp())
+                    {
+                        st.failed = true;
+                        break;
+                    }
+
+                    const auto t1 = std::chrono::steady_clock::now();
+                    const int64_t lat =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+                    st.latencyMin = std::min(st.latencyMin, lat);
+                    st.latencyMax = std::max(st.latencyMax, lat);
+                    st.latencySum += lat;
+                    ++st.stamps;
+                }
+
+                stats[i] = st;
+            };
+
+            // if a thread cannot be started the running ones have to be stopped and joined
+            try
+            {
+                for (uint32_t i = 0; i < threads; ++i)
+                    workers.emplace_back(worker, i);
+            }
+            catch (...)
+            {
+                done = true;
+                go = true;
+                for (std::thread &w : workers)
+                    w.join();
+                throw;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            go = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+            done = true;
+            for (std::thread &worker : workers)
+                worker.join();
+            const auto stop = std::chrono::steady_clock::now();
+
+            result.type = type;
+            result.threads = threads;
+            result.stamps = 0;
+            result.seconds = std::chrono::duration<double>(stop - start).count();
+            result.latencyMin = std::numeric_limits<int64_t>::max();
+            result.latencyMax = 0;
+
+            int64_t sum = 0;
+
+            for (uint32_t i = 0; i < threads; ++i)
+            {
+                if (stats[i].failed)
+                {
+                    _err = channels[i]->error();
+                    return false;
+                }
+
+                result.stamps += stats[i].stamps;
+                result.latencyMin = std::min(result.latencyMin, stats[i].latencyMin);
+                result.latencyMax = std::max(result.latencyMax, stats[i].latencyMax);
+                sum += stats[i].latencySum;
+            }
+
+            if (!result.stamps)
+                result.latencyMin = 0;
+            result.latencyMean = result.stamps ? sum / static_cast<int64_t>(result.stamps) : 0;
+        }
+        catch (std::exception &e)
+        {
+            _err = e.what();
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string Bench::error() noexcept(false)
+    {
+        const std::string tmp(_err);
+
+        _err.clear();
+
+        return tmp;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Channel.hxx"
+
+namespace Stamp
+{
+    // hammers the testsysfs module with stamps from a number of threads, every thread with its
+    // own channel, and measures the cost of a single stamp
+    class Bench {
+    public:
+        struct Result {
+            Channel::Type type;
+            uint32_t threads;
+            uint64_t stamps;        // stamps of all threads
+            double seconds;         // measured duration
+            int64_t latencyMin;     // duration of a single stamp call (ns)
+            int64_t latencyMean;
+            int64_t latencyMax;
+        };
+
+        //--- public constructors ---
+        Bench(const std::string &devname, const std::string &attrname) noexcept;
+        Bench(const Bench &rhs) = delete;
+        Bench(Bench &&rhs) = delete;
+        virtual ~Bench() noexcept;
+
+        //--- public operators ---
+        Bench &operator=(const Bench &rhs) = delete;
+        Bench &operator=(Bench &&rhs) = delete;
+
+        //--- public methods ---
+        bool run(const Channel::Type type, const uint32_t threads, const uint32_t duration_ms,
+                 Result &result) noexcept;
+        std::string error() noexcept(false);
+
+    private:
+        //--- private properties ---
+        std::string _devname;
+        std::string _attrname;
+        std::string _err;
+    };
+}
@@ -0,0 +1,147 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "Channel.hxx"
+#include "testsysfs.h"
+
+namespace Stamp
+{
+    //--- public constructors ---
+
+    Channel::Channel(const Type type, const std::string &devname, const std::string &attrname)
+        noexcept(false)
+    : _type(type), _devname(devname), _attrname(attrname), _fd(-1), _eventfd(-1), _err(0)
+    {
+        if (!open())
+            throw std::runtime_error(::strerror(_err));
+    }
+
+    Channel::~Channel() noexcept
+    {
+        close();
+    }
+
+    //--- public methods ---
+
+    bool Channel::stamp() noexcept
+    {
+        static const char one = '1';
+        const uint64_t count = 1;
+        ssize_t ret = -1;
+
+        switch (_type)
+        {
+            case Type::Sysfs:
+                ret = ::pwrite(_fd, &one, sizeof(one), 0);
+                break;
+            case Type::Ioctl:
+                ret = ::ioctl(_fd, TESTSYSFS_IOC_STAMP);
+                break;
+            case Type::Write:
+                ret = ::write(_fd, &one, sizeof(one));
+                break;
+            case Type::Eventfd:
+                ret = ::write(_eventfd, &count, sizeof(count));
+                break;
+        }
+
+        if (ret < 0)
+        {
+            _err = errno;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string Channel::error() noexcept(false)
+    {
+        if (_err)
+        {
+            const std::string tmp(strerror(_err));
+
+            _err = 0;
+
+            return tmp;
+        }
+
+        return "";
+    }
+
+    std::string Channel::typeName(const Type type) noexcept(false)
+    {
+        switch (type)
+        {
+            case Type::Sysfs:
+                return "sysfs";
+            case Type::Ioctl:
+                return "ioctl";
+            case Type::Write:
+                return "write";
+            case Type::Eventfd:
+                return "eventfd";
+        }
+
+        return "unknown";
+    }
+
+    bool Channel::parseType(const std::string &name, Type &type) noexcept
+    {
+        static const Type types[] = {Type::Sysfs, Type::Ioctl, Type::Write, Type::Eventfd};
+
+        for (const Type t : types)
+        {
+            if (name == typeName(t))
+            {
+                type = t;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //--- protected methods ---
+
+    bool Channel::open() noexcept
+    {
+        if (_type == Type::Sysfs)
+            _fd = ::open(_attrname.c_str(), O_WRONLY | O_CLOEXEC);
+        else
+            _fd = ::open(_devname.c_str(), O_RDWR | O_CLOEXEC);
+
+        if (_fd < 0)
+        {
+            _err = errno;
+            return false;
+        }
+
+        if (_type == Type::Eventfd)
+        {
+            _eventfd = ::eventfd(0, EFD_CLOEXEC);
+            if ((_eventfd < 0) || (::ioctl(_fd, TESTSYSFS_IOC_EVENTFD, &_eventfd) < 0))
+            {
+                _err = errno;
+                close();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Channel::close() noexcept
+    {
+        if (_eventfd > -1)
+            ::close(_eventfd);
+        _eventfd = -1;
+
+        if (_fd > -1)
+            ::close(_fd);
+        _fd = -1;
+    }
+}
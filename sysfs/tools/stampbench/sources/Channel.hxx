@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Stamp
+{
+    // one way of asking the testsysfs module for a stamp, every thread uses its own channel
+    class Channel {
+    public:
+        enum class Type {
+            Sysfs,      // write to the stamped_time attribute
+            Ioctl,      // TESTSYSFS_IOC_STAMP on /dev/testsysfs
+            Write,      // write() to /dev/testsysfs
+            Eventfd     // write to an eventfd bound with TESTSYSFS_IOC_EVENTFD
+        };
+
+        //--- public constructors ---
+        Channel(const Type type, const std::string &devname, const std::string &attrname)
+            noexcept(false);
+        Channel(const Channel &rhs) = delete;
+        Channel(Channel &&rhs) = delete;
+        virtual ~Channel() noexcept;
+
+        //--- public operators ---
+        Channel &operator=(const Channel &rhs) = delete;
+        Channel &operator=(Channel &&rhs) = delete;
+
+        //--- public methods ---
+        bool stamp() noexcept;
+        std::string error() noexcept(false);
+
+        static std::string typeName(const Type type) noexcept(false);
+        static bool parseType(const std::string &name, Type &type) noexcept;
+
+    protected:
+        //--- protected methods ---
+        bool open() noexcept;
+        void close() noexcept;
+
+    private:
+        //--- private properties ---
+        Type _type;
+        std::string _devname;
+        std::string _attrname;
+        int32_t _fd;
+        int32_t _eventfd;
+        int32_t _err;   // 0 = not set/unused, positive number = errno set
+    };
+}
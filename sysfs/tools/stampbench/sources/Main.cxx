@@ -0,0 +1,146 @@
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Bench.hxx"
+
+static const std::string DefaultDevice("/dev/testsysfs");
+static const std::string DefaultAttribute("/sys/kernel/testsysfs/stamped_time");
+static const std::string DefaultMethods("sysfs,ioctl,write,eventfd");
+static const uint32_t DefaultThreads = 4;
+static const uint32_t DefaultDuration = 2000;
+
+bool bench(const std::string &devname, const std::string &attrname,
+           const std::vector<Stamp::Channel::Type> &methods, const uint32_t threads,
+           const uint32_t duration_ms) noexcept
+{
+    Stamp::Bench bench(devname, attrname);
+
+    std::cout << "  method  threads      stamps/s  stamps/s/thread     lat min    lat mean"
+              << "     lat max" << std::endl;
+
+    for (const Stamp::Channel::Type method : methods)
+    {
+        for (uint32_t n = 1; n <= threads; ++n)
+        {
+            Stamp::Bench::Result result;
+
+            if (!bench.run(method, n, duration_ms, result))
+            {
+                std::cerr << "error: " << Stamp::Channel::typeName(method) << " benchmark with "
+                          << n << " threads failed (" << bench.error() << ')' << std::endl;
+                return false;
+            }
+
+            const double rate = result.stamps / result.seconds;
+
+            std::cout << std::setw(8) << Stamp::Channel::typeName(result.type)
+                      << std::setw(9) << result.threads
+                      << std::setw(14) << static_cast<uint64_t>(rate)
+                      << std::setw(17) << static_cast<uint64_t>(rate / result.threads)
+                      << std::setw(12) << result.latencyMin
+                      << std::setw(12) << result.latencyMean
+                      << std::setw(12) << result.latencyMax << std::endl;
+        }
+    }
+
+    return true;
+}
+
+void usage(const std::string &appname) noexcept
+{
+    std::cout << "usage: " << appname << "<option>\n"
+              << "options:\n"
+              << "  --help           show this help screen\n"
+              << "  --device=<dev>   path to the testsysfs device (default: " << DefaultDevice
+                  << ")\n"
+              << "  --sysfs=<path>   path to the stamp attribute (default: " << DefaultAttribute
+                  << ")\n"
+              << "  --methods=<list> comma separated stamp methods (default: " << DefaultMethods
+                  << ")\n"
+              << "  --threads=<n>    run every method with 1 up to n threads (default: "
+                  << DefaultThreads << ")\n"
+              << "  --duration=<ms>  duration of a single run (default: " << DefaultDuration
+                  << ")\n"
+              << std::endl;
+}
+
+int32_t main(int32_t argc, char **argv) noexcept
+{
+    std::string devname = DefaultDevice;
+    std::string attrname = DefaultAttribute;
+    std::string methods = DefaultMethods;
+    uint32_t threads = DefaultThreads;
+    uint32_t duration = DefaultDuration;
+    std::vector<Stamp::Channel::Type> types;
+
+    try
+    {
+        for (int32_t i = 1; i < argc; ++i)
+        {
+            std::string arg(argv[i]);
+
+            if (arg == "--help")
+            {
+                usage(argv[0]);
+                return 0;
+            }
+
+            if ((arg.size() > 9) && (arg.substr(0, 9) == "--device="))
+            {
+                devname = arg.substr(9, std::string::npos);
+                continue;
+            }
+
+            if ((arg.size() > 8) && (arg.substr(0, 8) == "--sysfs="))
+            {
+                attrname = arg.substr(8, std::string::npos);
+                continue;
+            }
+
+            if ((arg.size() > 10) && (arg.substr(0, 10) == "--methods="))
+            {
+                methods = arg.substr(10, std::string::npos);
+                continue;
+            }
+
+            if ((arg.size() > 10) && (arg.substr(0, 10) == "--threads="))
+            {
+                threads = std::stoul(arg.substr(10, std::string::npos));
+                continue;
+            }
+
+            if ((arg.size() > 11) && (arg.substr(0, 11) == "--duration="))
+            {
+                duration = std::stoul(arg.substr(11, std::string::npos));
+                continue;
+            }
+        }
+
+        std::istringstream list(methods);
+        std::string method;
+
+        while (std::getline(list, method, ','))
+        {
+            Stamp::Channel::Type type;
+
+            if (!Stamp::Channel::parseType(method, type))
+            {
+                std::cerr << "error: unknown method " << method << std::endl;
+                return 1;
+            }
+            types.push_back(type);
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!threads)
+        threads = 1;
+
+    return bench(devname, attrname, types, threads, duration) ? 0 : 1;
+}